@@ -0,0 +1,50 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+
+class HogDetector;
+
+// Quality ladder, best first. Each level keeps the savings of the previous one.
+enum QualityLevel {
+    QUALITY_FULL = 0,     // Full resolution, every pixel row
+    QUALITY_ROW_SKIP = 1, // Gradient pass on every other pixel row
+    QUALITY_LUMA = 2,     // + single-channel gradient (CPU backends only)
+    QUALITY_HALF_RES = 3, // + input downscaled by 2
+    QUALITY_LEVEL_COUNT = 4
+};
+
+// Deadline-driven controller: keeps a running latency estimate per level
+// and picks the best level whose estimate fits inside the per-frame budget.
+class AdaptiveQuality {
+public:
+    AdaptiveQuality(double budgetMs, const HogDetector* detector);
+
+    int currentLevel() const { return level; }
+
+    // Applies the knobs of the current level: sets the detector row step and
+    // writes the (possibly converted / downscaled) frame to 'output'.
+    void prepareFrame(const cv::Mat& input, HogDetector* detector, cv::Mat& output) const;
+
+    // Feeds the measured latency of the frame just processed at the current level.
+    void record(double ms);
+
+private:
+    struct Estimate {
+        bool valid = false;
+        double mean = 0.0; // Smoothed latency
+        double dev = 0.0;  // Smoothed mean deviation
+        double predicted() const;
+    };
+
+    double budgetMs;
+    bool grayscaleSupported;
+    int level = QUALITY_FULL;
+    Estimate estimates[QUALITY_LEVEL_COUNT];
+
+    int calmFrames = 0;    // Frames in a row with plenty of headroom
+    int probeInterval;     // Grows after failed attempts to raise quality
+    bool probing = false;  // Current level was entered by a probe
+
+    bool supported(int lvl) const;
+    int cheaper(int lvl) const;
+    int better(int lvl) const;
+};
@@ -0,0 +1,18 @@
+#pragma once
+#include <string>
+#include <vector>
+
+class HogDetector;
+
+struct ComparedBackend {
+    std::string name;
+    HogDetector* detector;
+};
+
+// Cross-backend comparison: identical frames go through every backend.
+// Reports throughput side by side and per-cell differences against the
+// first backend in the list (the reference).
+class BackendComparison {
+public:
+    static void run(const std::vector<ComparedBackend>& backends, const std::string& inputPath);
+};
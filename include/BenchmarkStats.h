@@ -0,0 +1,13 @@
+#pragma once
+
+// One processed frame, as logged to the per-frame CSV. Plain data, no OpenCV,
+// so the latency tooling can use it without pulling in Utils.h.
+struct BenchmarkStats {
+    int frameId;
+    int width;
+    int height;
+    double timeMs;
+    int quality = 0; // QualityLevel used for this frame (0 = full)
+    double hashMs = 0.0; // Result cache: frame hashing, included in timeMs
+    int cacheHit = 0;    // 1 = histograms came from the result cache
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class HogDetector;
+
+// Which part of the dataset a worker process owns.
+// Image k of the sorted file list belongs to shard (k % count).
+struct ShardSpec {
+    int index = 0;
+    int count = 1;
+};
+
+// Dataset-scale descriptor extraction, split across processes / machines that
+// share nothing but a filesystem.
+//
+// extract(): one process per shard. Appends one committed record per image to
+//   <outputDir>/shard_<i>_of_<n>.bin and flushes it, then writes shard_<i>_of_<n>.done.
+//   A rerun after a crash truncates the torn record at the tail, skips every image
+//   already committed and carries on, so each image ends up in the output exactly once.
+//
+// merge(): once every shard is done, concatenates them in image order into
+//   <outputDir>/features.bin plus <outputDir>/manifest.csv, checking that every
+//   image of the list is present exactly once.
+//
+// features.bin (little-endian):
+//   FeatureFileHeader, then per image in index order:
+//   FeatureRecordHeader, 'floatCount' floats (block descriptor, see computeBlockDescriptor).
+//   manifest.csv gives the byte offset of every record.
+class DatasetShards {
+public:
+    static constexpr char FEATURE_MAGIC[8] = { 'H', 'O', 'G', 'F', 'E', 'A', 'T', '1' };
+
+    struct FeatureFileHeader {
+        char magic[8];
+        uint64_t imageCount;
+        uint64_t listHash; // Identifies the sorted file list the shards were built from
+    };
+
+    struct FeatureRecordHeader {
+        uint64_t index;      // Position in the sorted file list
+        int32_t cellsX;
+        int32_t cellsY;
+        uint32_t floatCount; // 0 if the image could not be read
+        uint32_t status;     // 0 = ok, 1 = unreadable
+    };
+
+    // Sorted image paths under 'inputDir' (recursive), relative to it.
+    static std::vector<std::string> listImages(const std::string& inputDir);
+
+    // Returns 0 on success (also when the shard was already complete).
+    static int extract(HogDetector* detector, const std::string& inputDir, const std::string& outputDir, ShardSpec shard);
+    static int merge(const std::string& outputDir);
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <vector>
+#include "ThreadPool.h"
+
+// Execution policies for HogCPU<Policy>.
+// Each one runs body(i) for i in [begin, end). Iterations are independent
+// (one image row or one cell row each), so any order or interleaving is valid.
+
+struct SequentialPolicy {
+    static constexpr const char* NAME = "Sequential";
+
+    template <class Body>
+    static void forRange(int begin, int end, Body&& body) {
+        for (int i = begin; i < end; i++) body(i);
+    }
+};
+
+struct OpenMPPolicy {
+    static constexpr const char* NAME = "OpenMP";
+
+    template <class Body>
+    static void forRange(int begin, int end, Body&& body) {
+        #pragma omp parallel for schedule(static)
+        for (int i = begin; i < end; i++) body(i);
+    }
+};
+
+// C++17 parallel algorithms. With libstdc++ this runs on TBB when it is
+// available at build time and falls back to a serial loop otherwise.
+struct StdParPolicy {
+    static constexpr const char* NAME = "StdPar";
+
+    template <class Body>
+    static void forRange(int begin, int end, Body&& body) {
+        if (end <= begin) return;
+        // Row counts are small (image height), so materializing the indices is cheap.
+        thread_local std::vector<int> indices;
+        indices.resize(end - begin);
+        std::iota(indices.begin(), indices.end(), begin);
+        std::for_each(std::execution::par_unseq, indices.begin(), indices.end(), body);
+    }
+};
+
+// Task-based: chunks of the range become tasks on the shared ThreadPool.
+struct TaskPolicy {
+    static constexpr const char* NAME = "Tasks";
+
+    template <class Body>
+    static void forRange(int begin, int end, Body&& body) {
+        ThreadPool::global().parallelFor(begin, end, body);
+    }
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include "HogDetector.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Identity of a frame: content hash + everything else that changes its histograms.
+struct FrameKey {
+    uint64_t hash = 0;
+    int width = 0;
+    int height = 0;
+    int type = 0;    // cv::Mat type (grayscale frames give different histograms)
+    int rowStep = 1; // Adaptive quality level of the gradient pass
+    HistogramLayout layout = HistogramLayout::CellMajor;
+
+    bool operator==(const FrameKey& o) const {
+        return hash == o.hash && width == o.width && height == o.height && type == o.type &&
+               rowStep == o.rowStep && layout == o.layout;
+    }
+};
+
+// Cell histograms of one frame, in the layout the backend produced them.
+struct CachedGrid {
+    AlignedFloatVector data;
+    int cellsX = 0;
+    int cellsY = 0;
+    int cellStride = 0;
+    size_t rowStride = 0;
+
+    HistogramGrid view() const { return { data.data(), cellsX, cellsY, cellStride, rowStride }; }
+    size_t bytes() const { return data.size() * sizeof(float) + sizeof(CachedGrid); }
+};
+
+// Content-addressed LRU of histogram grids with a memory budget. Thread-safe, so
+// several detectors (e.g. stream workers) may share one cache.
+class FrameCache {
+public:
+    explicit FrameCache(size_t budgetBytes);
+
+    // XXH64 of the pixel bytes, row by row (ROIs and padded rows are fine).
+    static uint64_t hashFrame(const cv::Mat& img);
+    static uint64_t xxh64(const void* data, size_t length, uint64_t seed);
+
+    // Marks the entry most recently used. nullptr on a miss.
+    std::shared_ptr<const CachedGrid> find(const FrameKey& key);
+    // Copies 'grid'; evicts least recently used entries to stay within the budget.
+    // Grids larger than the whole budget are not stored.
+    void insert(const FrameKey& key, const HistogramGrid& grid);
+
+    size_t sizeBytes() const;
+    size_t entryCount() const;
+    size_t evictionCount() const;
+
+private:
+    struct KeyHash {
+        size_t operator()(const FrameKey& k) const { return (size_t)k.hash; }
+    };
+    using Entry = std::pair<FrameKey, std::shared_ptr<const CachedGrid>>;
+
+    size_t budget;
+    size_t used = 0;
+    size_t evictions = 0;
+    std::list<Entry> lru; // Front = most recently used
+    std::unordered_map<FrameKey, std::list<Entry>::iterator, KeyHash> index;
+    mutable std::mutex lock;
+};
+
+// Per-frame cache accounting of CachedHogDetector.
+struct CacheFrameStats {
+    double hashMs = 0.0; // Hashing the frame (paid on hits and misses)
+    bool hit = false;
+};
+
+// Decorator: frames seen before (frozen cameras, static slates, looped inputs) return
+// their stored histograms instead of running the backend.
+// Entries are shared, so a hit stays valid after the cache evicts it.
+class CachedHogDetector : public HogDetector {
+private:
+    HogDetector* backend; // Not owned
+    FrameCache* cache;    // Not owned
+
+    HistogramLayout layout = HistogramLayout::CellMajor;
+    std::shared_ptr<const CachedGrid> current; // Grid of the last frame, on a hit
+    CacheFrameStats stats;
+
+public:
+    CachedHogDetector(HogDetector* backend, FrameCache* cache);
+    ~CachedHogDetector() override { waitForPending(); }
+
+    cv::Mat computeHOG(const cv::Mat& input, bool visualize) override;
+    HistogramGrid getHistogramGrid() const override;
+    bool setHistogramLayout(HistogramLayout layout) override;
+    void setRowStep(int step) override;
+    bool supportsGrayscale() const override { return backend->supportsGrayscale(); }
+
+    const CacheFrameStats& lastStats() const { return stats; }
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "HogDetector.h"
+
+// Execution policies live in ExecutionPolicies.h; only HogCPU.cpp needs their definitions.
+struct SequentialPolicy;
+struct OpenMPPolicy;
+struct StdParPolicy;
+struct TaskPolicy;
+
+// Single CPU implementation of the HOG pipeline.
+// 'Policy' only decides how the independent row loops are distributed, so every
+// optimization lands in all CPU backends at once.
+// Explicitly instantiated in HogCPU.cpp for the policies listed above.
+template <class Policy>
+class HogCPU : public HogDetector {
+private:
+    // Optimization: Multiply by scale instead of dividing by step
+    float binScale;
+
+    // --- Memory Reuse ---
+    cv::Mat mag, ang;
+    HistogramLayout layout = HistogramLayout::CellMajor;
+    AlignedFloatVector cellHistograms;
+    cv::Size gridSize;
+    // --------------------
+
+    void computeGradients(const cv::Mat& img, cv::Mat& mag, cv::Mat& ang);
+    void computeCells(const cv::Mat& mag, const cv::Mat& ang, AlignedFloatVector& cellHistograms, cv::Size& gridSize);
+    template <int CellStride>
+    void accumulateCells(const cv::Mat& mag, const cv::Mat& ang, float* hist, size_t rowStride, const cv::Size& gridSize);
+
+    // Async: every in-flight frame borrows a scratch detector from this free list,
+    // so frames run concurrently on the shared ThreadPool. Scratch detectors are always
+    // sequential: the pool already spreads frames over the cores, and an OpenMP team (or
+    // nested pool tasks) inside each pool worker would oversubscribe them N-fold.
+    std::mutex scratchLock;
+    std::vector<std::unique_ptr<HogCPU<SequentialPolicy>>> scratchFree;
+
+public:
+    HogCPU();
+    ~HogCPU() override;
+    cv::Mat computeHOG(const cv::Mat& input, bool visualize) override;
+    std::future<HogResult> computeHOGAsync(const cv::Mat& input, bool visualize = false, HogCallback onComplete = nullptr) override;
+    bool supportsGrayscale() const override { return true; }
+    HistogramGrid getHistogramGrid() const override;
+    bool setHistogramLayout(HistogramLayout newLayout) override;
+};
+
+using HogSequential = HogCPU<SequentialPolicy>;
+using HogOpenMP = HogCPU<OpenMPPolicy>;
+using HogStdPar = HogCPU<StdParPolicy>;
+using HogTasks = HogCPU<TaskPolicy>;
+
+extern template class HogCPU<SequentialPolicy>;
+extern template class HogCPU<OpenMPPolicy>;
+extern template class HogCPU<StdParPolicy>;
+extern template class HogCPU<TaskPolicy>;
@@ -1,10 +1,13 @@
 #pragma once
 #include "HogDetector.h"
+#include <condition_variable>
+#include <mutex>
 #include <vector>
 
 // Forward declaration to avoid including cuda_runtime.h in the header
 // (Keeps compile times fast for non-CUDA files)
 struct float3; 
+struct CUstream_st; // cudaStream_t == CUstream_st*
 
 class HogCUDA : public HogDetector {
 private:
@@ -17,13 +20,37 @@ private:
 
     int currentWidth = 0;
     int currentHeight = 0;
+    size_t imgCapacity = 0;  // Allocated bytes (>= current frame)
+    size_t histCapacity = 0; // Allocated floats, also the size of each pinned buffer
+
+    // Every frame, sync or async, goes through this stream, so frames are
+    // serialized on the shared device buffers.
+    CUstream_st* stream = nullptr;
+
+    // Async: pinned download buffers, one per in-flight frame
+    std::mutex pinnedLock;
+    std::condition_variable pinnedReturned;
+    std::vector<float*> pinnedFree;
+    int pinnedCount = 0;
 
     void allocateBuffers(int width, int height);
     void cleanup();
+    float* acquirePinned();
+    void releasePinned(float* buffer);
+
+    struct AsyncRequest;
+    static void onFrameDone(void* userData);
 
 public:
     HogCUDA();
     ~HogCUDA();
 
+    // True if a CUDA device is present (the kernels exit on CUDA errors).
+    static bool isAvailable();
+
     cv::Mat computeHOG(const cv::Mat& input, bool visualize) override;
+    // onComplete runs on the CUDA callback thread and stalls the stream while it runs
+    std::future<HogResult> computeHOGAsync(const cv::Mat& input, bool visualize = false, HogCallback onComplete = nullptr) override;
+    // Reflects the last computeHOG() call; async results arrive in HogResult
+    HistogramGrid getHistogramGrid() const override;
 };
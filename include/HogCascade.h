@@ -0,0 +1,89 @@
+#pragma once
+#include "HogDetector.h"
+#include <ostream>
+#include <vector>
+
+// Per-frame breakdown of one cascade pass.
+struct CascadeFrameStats {
+    int frameId = 0;
+    double coarseMs = 0.0;       // Half-resolution pass + window scoring
+    double fineMs = 0.0;         // Full-resolution pass over the surviving regions
+    double fullMs = 0.0;         // Reference: full-resolution pass over the whole frame
+    double prunedFraction = 0.0; // Share of full-resolution cells never computed
+    int windowsKept = 0;
+    int windowsTotal = 0;
+    int regions = 0;
+
+    double speedup() const { return (coarseMs + fineMs) > 0.0 ? fullMs / (coarseMs + fineMs) : 0.0; }
+};
+
+// Running sums of CascadeFrameStats for the end-of-run summary (constant memory).
+struct CascadeTotals {
+    size_t frames = 0;
+    double coarseMs = 0.0;
+    double fineMs = 0.0;
+    double fullMs = 0.0;
+    double prunedFraction = 0.0;
+
+    void add(const CascadeFrameStats& s) {
+        frames++;
+        coarseMs += s.coarseMs;
+        fineMs += s.fineMs;
+        fullMs += s.fullMs;
+        prunedFraction += s.prunedFraction;
+    }
+};
+
+// Coarse-to-fine decorator around any backend.
+// 1. The backend runs on a 2x-downscaled frame: one coarse cell covers 2x2 full cells.
+// 2. Every detection window (Utils::WIN_WIDTH x WIN_HEIGHT, one coarse cell stride) is
+//    scored by its gradient energy; windows below 'threshold' x (best score of the frame) are dropped.
+// 3. Full-resolution cells are computed only inside the surviving windows, one backend
+//    call per connected region (plus a 1-cell margin so border cells see their neighbours).
+// Pruned cells stay zero in the output grid.
+class HogCascade : public HogDetector {
+private:
+    HogDetector* backend; // Not owned
+    double threshold;
+
+    std::vector<float> cellHistograms; // Full-resolution grid, cell-major
+    cv::Size gridSize;
+
+    // --- Memory Reuse ---
+    cv::Mat half;
+    std::vector<double> energy;   // Integral image of coarse cell energies
+    std::vector<int> coverage;    // Surviving windows per coarse cell
+    cv::Mat cellMask;             // Full-resolution cells inside a surviving window
+    cv::Mat regionMask, labels, regionStats, centroids;
+    cv::Mat lastInput;            // Frame of the last computeHOG, for measureFullPass()
+    // --------------------
+
+    CascadeFrameStats stats;
+
+    bool beginFrame(const cv::Mat& input);
+    void selectCells(const HistogramGrid& coarse);
+    void computeRegions(const cv::Mat& input, std::vector<cv::Rect>& regions);
+
+public:
+    // threshold in (0, 1]: relative to the best window of each frame. Higher prunes more.
+    HogCascade(HogDetector* backend, double threshold);
+    ~HogCascade() override { waitForPending(); }
+
+    cv::Mat computeHOG(const cv::Mat& input, bool visualize) override;
+    // Fine pass only, over a caller-supplied cell mask (CV_8U, one byte per full-resolution
+    // cell, non-zero = keep) instead of the coarse pass. For external region proposals and tests.
+    void computeMasked(const cv::Mat& input, const cv::Mat& mask);
+    HistogramGrid getHistogramGrid() const override;
+    void setRowStep(int step) override;
+    bool supportsGrayscale() const override { return backend->supportsGrayscale(); }
+
+    // Times the backend on the whole frame of the last computeHOG call, as the
+    // reference for speedup(). Call outside the timed section; the cascade grid is kept.
+    void measureFullPass();
+
+    const CascadeFrameStats& lastStats() const { return stats; }
+
+    // Per-frame stage log (see CsvRowLog in LatencyRecorder.h): header and one row.
+    static const char* const STATS_CSV_HEADER;
+    static void writeStatsRow(std::ostream& out, const CascadeFrameStats& s);
+};
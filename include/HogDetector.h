@@ -1,6 +1,24 @@
 #pragma once
 #include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
 #include <vector>
+#include "HogLayout.h"
+
+// Result of one asynchronous computeHOG. Owns its data, unlike getHistogramGrid().
+struct HogResult {
+    cv::Mat visual;                    // Empty unless visualization was requested
+    std::vector<float> cellHistograms; // Dense cell-major: BIN_COUNT floats per cell, row-major cells
+    cv::Size gridSize;                 // Cells
+};
+
+// Completion callback. Runs on a backend thread (pool worker / driver callback thread)
+// right before the future becomes ready, so keep it short.
+using HogCallback = std::function<void(const HogResult&)>;
 
 class HogDetector {
 public:
@@ -14,7 +32,28 @@ public:
     HogDetector() = default;
     virtual ~HogDetector() = default;
 
+    HogDetector(const HogDetector&) = delete;
+    HogDetector& operator=(const HogDetector&) = delete;
+
     virtual cv::Mat computeHOG(const cv::Mat& input, bool visualize = true) = 0;
+
+    // Cell histograms of the last computeHOG call (valid until the next call).
+    virtual HistogramGrid getHistogramGrid() const = 0;
+
+    // --- Asynchronous API ---
+    // Submits a frame and returns at once; many frames can be in flight from one thread.
+    // The input Mat is retained (ref-counted) until the frame completes: do not write to its pixels.
+    // Submit from one thread at a time, and do not mix with computeHOG while frames are in flight.
+    // Default: frames run one after another on the shared ThreadPool. Backends override this
+    // with their own queues (GPU) or per-frame scratch detectors (CPU).
+    virtual std::future<HogResult> computeHOGAsync(const cv::Mat& input, bool visualize = false, HogCallback onComplete = nullptr);
+
+    // Blocks until every frame submitted through computeHOGAsync has completed.
+    void waitForPending();
+
+    // Selects the histogram memory layout. Returns false if the backend
+    // only produces the default cell-major layout.
+    virtual bool setHistogramLayout(HistogramLayout layout) { return layout == HistogramLayout::CellMajor; }
     
     virtual long long getFeatureCount(const cv::Size& imgSize) const {
         //
@@ -23,4 +62,39 @@ public:
         if (cellsX <= 1 || cellsY <= 1) return 0;
         return (long long)(cellsX - 1) * (cellsY - 1) * 36; 
     }
+
+    // --- Adaptive Quality Knobs (see AdaptiveQuality.h) ---
+    // The gradient pass visits every 'step'-th pixel row (step must divide CELL_HEIGHT).
+    // Magnitudes are scaled by 'step' so histograms stay on the same scale.
+    virtual void setRowStep(int step) { rowStep = std::max(1, step); }
+    int getRowStep() const { return rowStep; }
+
+    // True if computeHOG accepts single-channel input (cheaper luma-only gradient).
+    virtual bool supportsGrayscale() const { return false; }
+
+protected:
+    int rowStep = 1;
+
+    // Dense cell-major copy of a grid (drops the padding of padded layouts).
+    static void copyToResult(const HistogramGrid& grid, HogResult& result);
+
+    // In-flight bookkeeping for waitForPending(). Backends call these around each async frame.
+    void asyncStarted();
+    void asyncFinished();
+
+private:
+    std::mutex asyncLock;
+    std::condition_variable asyncIdle;
+    int asyncInFlight = 0;
+
+    // Serial queue of the default implementation (the detector's buffers are not re-entrant)
+    struct AsyncJob {
+        cv::Mat input;
+        bool visualize;
+        HogCallback onComplete;
+        std::promise<HogResult> promise;
+    };
+    std::deque<AsyncJob> asyncQueue;
+    bool asyncDraining = false;
+    void drainAsyncQueue();
 };
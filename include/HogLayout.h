@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Memory layout of the cell histogram grid.
+enum class HistogramLayout {
+    CellMajor, // BIN_COUNT contiguous floats per cell (odd stride, compact)
+    Padded16   // Cells padded to 16 floats: one 64-byte line / AVX-512 register per cell
+};
+
+static constexpr int PADDED_CELL_STRIDE = 16;
+static constexpr size_t HIST_ALIGNMENT = 64;
+
+// Minimal aligned allocator so padded rows start on 64-byte boundaries.
+template <class T, size_t Align>
+struct AlignedAllocator {
+    using value_type = T;
+    template <class U> struct rebind { using other = AlignedAllocator<U, Align>; };
+
+    AlignedAllocator() = default;
+    template <class U> AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+    T* allocate(size_t n) {
+        size_t bytes = (n * sizeof(T) + Align - 1) / Align * Align;
+        void* p = std::aligned_alloc(Align, bytes);
+        if (!p) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+    void deallocate(T* p, size_t) { std::free(p); }
+
+    template <class U> bool operator==(const AlignedAllocator<U, Align>&) const { return true; }
+    template <class U> bool operator!=(const AlignedAllocator<U, Align>&) const { return false; }
+};
+
+using AlignedFloatVector = std::vector<float, AlignedAllocator<float, HIST_ALIGNMENT>>;
+
+// Read-only view of the cell histograms of the last computed frame, in any layout.
+struct HistogramGrid {
+    const float* data = nullptr;
+    int cellsX = 0;
+    int cellsY = 0;
+    int cellStride = 0;   // Floats between neighbouring cells
+    size_t rowStride = 0; // Floats between neighbouring cell rows
+
+    static HistogramGrid cellMajor(const float* data, int cellsX, int cellsY, int bins) {
+        return { data, cellsX, cellsY, bins, (size_t)cellsX * bins };
+    }
+
+    bool empty() const { return data == nullptr || cellsX <= 0 || cellsY <= 0; }
+    const float* cell(int cx, int cy) const { return data + cy * rowStride + (size_t)cx * cellStride; }
+};
+
+// Block normalization: 2x2-cell blocks, 1-cell stride, L2-Hys.
+// Writes (cellsX - 1) * (cellsY - 1) * 36 floats, the same count as HogDetector::getFeatureCount.
+// Specialized for each layout.
+void computeBlockDescriptor(const HistogramGrid& grid, std::vector<float>& descriptor);
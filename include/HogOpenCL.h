@@ -1,5 +1,6 @@
 #pragma once
 #include "HogDetector.h"
+#include <string>
 #include <vector>
 
 // Platform handling
@@ -9,32 +10,71 @@
 #include <CL/cl.h>
 #endif
 
+// Launch shape of the fused kernel. The best one differs a lot between CPU runtimes and
+// discrete GPUs, so autotune() measures it per device (see HogOpenCLTuner.cpp).
+struct OpenCLLaunchConfig {
+    int localX = 0;       // Work-group shape in work-items, 0 = let the runtime choose
+    int localY = 0;
+    int cellsPerItem = 1; // Horizontally adjacent cells computed by one work-item
+    int vectorWidth = 1;  // Pixels per vector op in the gradient/angle math (1, 2, 4, 8)
+
+    std::string describe() const;
+};
+
 class HogOpenCL : public HogDetector {
 private:
     // OpenCL Resources
     cl_context context;
+    cl_device_id device = NULL;
     cl_command_queue queue;
-    cl_program program;
-    cl_kernel kernelHog; // Single Fused Kernel
+    cl_program program = NULL;
+    cl_kernel kernelHog = NULL; // Single Fused Kernel
+    OpenCLLaunchConfig launch;  // Tuned configuration 'kernelHog' was built for
 
     // GPU Memory (Minimal set for Zero-Copy)
-    cl_mem d_input;     // Input Image
-    cl_mem d_hist;      // Output Histograms
+    cl_mem d_input = NULL;     // Input Image
+    cl_mem d_hist = NULL;      // Output Histograms
     
     // State tracking
     int currentWidth = 0;
     int currentHeight = 0;
+    size_t inputCapacity = 0; // Allocated bytes (>= current frame)
+    size_t histCapacity = 0;
     std::vector<float> cellHistograms;
 
     // Internal Helpers
     void initOpenCL();
     void compileKernels();
+    // Builds the kernel specialized for 'config'. Returns false (nothing to release) if the device rejects it.
+    bool buildKernel(const OpenCLLaunchConfig& config, cl_program& outProgram, cl_kernel& outKernel, bool reportErrors);
+    void launchKernel(cl_command_queue target, cl_kernel kernel, const OpenCLLaunchConfig& config, int cols, int rows, int step, cl_event* done);
+    bool loadTuning(OpenCLLaunchConfig& config) const;
+    void saveTuning(const OpenCLLaunchConfig& config, double medianMs) const;
     void allocateBuffers(int width, int height);
     void cleanup();
+    void enqueueFrame(const cv::Mat& img, float* hostHist, cl_bool blocking, cl_event* readDone);
+
+    // Async: the in-order queue serializes frames on the shared device buffers;
+    // each request owns its host input and output until the read event completes.
+    struct AsyncRequest;
+    static void CL_CALLBACK onReadComplete(cl_event event, cl_int status, void* userData);
 
 public:
     HogOpenCL();
     ~HogOpenCL();
     
     cv::Mat computeHOG(const cv::Mat& input, bool visualize) override;
+    std::future<HogResult> computeHOGAsync(const cv::Mat& input, bool visualize = false, HogCallback onComplete = nullptr) override;
+    // Reflects the last computeHOG() call; async results arrive in HogResult
+    HistogramGrid getHistogramGrid() const override;
+
+    // Sweeps work-group shapes, cells per work-item and vector widths on a synthetic
+    // 1920x1080 frame, writes every measurement to ../results/<csvName>, then saves the
+    // fastest configuration to tuningFile() and switches to it.
+    void autotune(const std::string& csvName = "OpenCL_Autotune.csv");
+
+    const OpenCLLaunchConfig& launchConfig() const { return launch; }
+    // Per device + driver, e.g. ../results/opencl_tuning/NVIDIA_GeForce_RTX_3060__535.104.05.cfg.
+    // Loaded automatically by the constructor when present.
+    std::string tuningFile() const;
 };
@@ -0,0 +1,26 @@
+#pragma once
+#include "HogDetector.h"
+#include <vector>
+
+// Reference backend wrapping cv::HOGDescriptor::compute.
+// Configured with one cell per block (8x8 block, 8x8 stride) so the descriptor maps
+// 1:1 onto our cell grid. Note that OpenCV's definition differs from ours: each cell is
+// L2-Hys normalized, votes are Gaussian-weighted and bins are centred half a bin later.
+class HogOpenCVRef : public HogDetector {
+private:
+    cv::HOGDescriptor hog;
+    std::vector<float> descriptor;     // OpenCV order: column-major over cells
+    std::vector<float> cellHistograms; // Our order: row-major, cell-major bins
+    cv::Size gridSize;
+    // Window 'hog' was built for. Not hog.winSize: a default HOGDescriptor already
+    // reports 64x128 (with 16x16 blocks), which would skip the first rebuild.
+    cv::Size configured{0, 0};
+
+public:
+    HogOpenCVRef() = default;
+    ~HogOpenCVRef() override { waitForPending(); }
+
+    cv::Mat computeHOG(const cv::Mat& input, bool visualize) override;
+    HistogramGrid getHistogramGrid() const override;
+    bool supportsGrayscale() const override { return true; }
+};
@@ -0,0 +1,24 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include "HogLayout.h"
+
+// Fast HOG visualization shared by every backend.
+// Each (bin, strength level) stroke is pre-rendered once as an anti-aliased alpha sprite;
+// a frame is then one darken pass plus sprite blends, parallel over cell rows.
+class HogVisualizer {
+public:
+    static constexpr int STRENGTH_LEVELS = 16;
+    static constexpr int GLYPH_SIZE = 24; // Sprite side in pixels, centred on the cell centre
+
+    // Darkened copy of 'image' (1 or 3 channels) with the strongest bins of every cell drawn on top.
+    // Thread-safe; 'output' is reused when it already has the right size.
+    // 'parallel' = false renders on the calling thread only (driver callback threads); on
+    // ThreadPool workers the render is always serial, the pool already fills the cores.
+    static void render(const HistogramGrid& grid, const cv::Mat& image, cv::Mat& output, bool parallel = true);
+
+    static cv::Mat render(const HistogramGrid& grid, const cv::Mat& image, bool parallel = true) {
+        cv::Mat output;
+        render(grid, image, output, parallel);
+        return output;
+    }
+};
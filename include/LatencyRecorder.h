@@ -0,0 +1,210 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BenchmarkStats.h"
+
+// Fixed-size log-linear latency histogram (HdrHistogram-style).
+// Values are kept in microseconds: exact below SUB_BUCKETS us, then SUB_BUCKETS / 2 linear
+// buckets per power of two (relative error < 2 / SUB_BUCKETS, ~1.6%) up to MAX_US (~71 min).
+// Recording is one index computation and one increment; memory never grows.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 7;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr uint64_t MAX_US = (1ull << 32) - 1;
+    static constexpr int MAGNITUDES = 32 - SUB_BUCKET_BITS; // Powers of two above the exact range
+    static constexpr int BUCKET_COUNT = SUB_BUCKETS + MAGNITUDES * (SUB_BUCKETS / 2);
+
+    void record(double ms);
+    void reset();
+
+    uint64_t count() const { return total; }
+    double meanMs() const { return total ? sumMs / total : 0.0; }
+    double maxMs() const { return maxUs / 1000.0; }
+    // p in [0, 100]. Upper edge of the bucket holding the p-th percentile (never above the max).
+    double percentile(double p) const;
+
+private:
+    std::array<uint64_t, BUCKET_COUNT> counts{};
+    uint64_t total = 0;
+    double sumMs = 0.0;
+    uint64_t maxUs = 0;
+
+    static int bucketIndex(uint64_t us);
+    static uint64_t bucketUpper(int index);
+};
+
+// Single-producer / single-consumer ring. Lock-free: an acquire load and a release store
+// per operation, and a full ring rejects the item instead of blocking the producer.
+template <class T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        slots.resize(n);
+        mask = n - 1;
+    }
+
+    bool push(const T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == slots.size()) return false;
+        slots[h & mask] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        out = slots[t & mask];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> slots;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> head{0}; // Next slot the producer writes
+    alignas(64) std::atomic<size_t> tail{0}; // Next slot the consumer reads
+};
+
+// Running totals of everything record() saw, for the end-of-run summaries.
+struct RecorderTotals {
+    static constexpr int MAX_QUALITY_LEVELS = 8;
+
+    uint64_t frames = 0;
+    double totalMs = 0.0;
+    double hashMs = 0.0;
+    uint64_t cacheHits = 0;
+    double cacheHitMs = 0.0;
+    uint64_t overBudget = 0;
+    uint64_t perQuality[MAX_QUALITY_LEVELS] = {};
+};
+
+// Background CSV log (../results/<csvName>): one producer queues rows through an SpscRing,
+// a writer thread formats and writes them, flushing several times per second so a crash
+// loses well under a second of rows. The file and the thread are only created with the
+// first row, so a log that never gets one leaves no file. Pushing never waits on I/O:
+// if the writer falls behind, rows are dropped and counted.
+// The row type lives in CsvRowLog<Row>; this part owns the file and the thread.
+class CsvLogWriter {
+public:
+    // 'description' names the file in the "[Saved] ..." line. Empty csvName = no log.
+    CsvLogWriter(const std::string& csvName, const std::string& header, const std::string& description);
+    virtual ~CsvLogWriter();
+
+    CsvLogWriter(const CsvLogWriter&) = delete;
+    CsvLogWriter& operator=(const CsvLogWriter&) = delete;
+
+    // Stops the writer after it has written every queued row. Idempotent.
+    void finish();
+
+protected:
+    static size_t queueCapacity();
+
+    // Opens the file and starts the writer. Called once, with the queue already in place.
+    bool start();
+
+    uint64_t droppedRows = 0; // Producer side only
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Writer thread: formats every queued row into 'out'. True if there was any.
+    virtual bool drainRows(std::ostream& out) = 0;
+    void writerLoop();
+
+    std::string csvName;
+    std::string header;
+    std::string description;
+    std::string csvPath;
+    std::ofstream log; // Owned by the writer thread once it runs
+    std::thread writer;
+    std::atomic<bool> stopping{false};
+};
+
+template <class Row>
+class CsvRowLog : public CsvLogWriter {
+public:
+    using Formatter = void (*)(std::ostream& out, const Row& row);
+
+    CsvRowLog(const std::string& csvName, const std::string& header, const std::string& description, Formatter format)
+        : CsvLogWriter(csvName, header, description), format(format) {}
+    // The writer reads 'queue': stop it before the queue goes away
+    ~CsvRowLog() override { finish(); }
+
+    void push(const Row& row) {
+        if (!started) {
+            started = true;
+            queue = std::make_unique<SpscRing<Row>>(queueCapacity());
+            if (!start()) queue.reset();
+        }
+        if (queue && !queue->push(row)) droppedRows++;
+    }
+
+private:
+    Formatter format;
+    bool started = false;
+    std::unique_ptr<SpscRing<Row>> queue;
+
+    bool drainRows(std::ostream& out) override {
+        Row row;
+        bool wrote = false;
+        while (queue->pop(row)) {
+            format(out, row);
+            wrote = true;
+        }
+        return wrote;
+    }
+};
+
+// Bounded-memory replacement for a per-frame stats vector:
+// - an overall and a rolling LatencyHistogram, with a p50/p99/max/fps line every
+//   'summaryIntervalSec' of wall time (0 = no rolling lines);
+// - optionally the per-frame CSV (../results/<csvName>, same columns as before) through a
+//   CsvRowLog, so a recorder that sees no frames leaves no file.
+// record() is called from one thread at a time (or under a lock) and never waits on I/O.
+class LatencyRecorder {
+public:
+    LatencyRecorder(const std::string& label, const std::string& csvName, double summaryIntervalSec = 1.0);
+
+    LatencyRecorder(const LatencyRecorder&) = delete;
+    LatencyRecorder& operator=(const LatencyRecorder&) = delete;
+
+    // Frames slower than this count as over budget in totals(). 0 = off.
+    void setBudgetMs(double ms) { budgetMs = ms; }
+
+    void record(const BenchmarkStats& s);
+
+    // Stops the writer after it has written every queued row. Idempotent.
+    void finish() { log.finish(); }
+
+    const LatencyHistogram& overall() const { return total; }
+    const RecorderTotals& totals() const { return sums; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::string label;
+    double summaryIntervalMs;
+    double budgetMs = 0.0;
+
+    LatencyHistogram total;
+    LatencyHistogram window;
+    RecorderTotals sums;
+    Clock::time_point windowStart;
+    int windowFirstFrame = 0;
+
+    CsvRowLog<BenchmarkStats> log; // Per-frame rows
+
+    static void writeRow(std::ostream& out, const BenchmarkStats& s);
+    void printWindow(double elapsedMs);
+};
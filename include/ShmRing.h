@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Shared-memory ring buffer protocol between HOG_App (single producer) and
+// any number of consumer processes. Plain C++17, no OpenCV: consumers only
+// need this header and ShmRingReader.h.
+//
+// Memory map of the POSIX shm object:
+//   [RingHeader][Slot 0][Slot 1]...[Slot slotCount-1]
+//   Slot = [SlotHeader][payload: cellsY rows of cellsX * cellStride floats]
+//
+// Frames are numbered 1, 2, 3... Frame n lives in slot (n - 1) % slotCount.
+// Each slot is a seqlock: SlotHeader::seq is (n << 1) | 1 while frame n is being
+// written and (n << 1) once it is published. The writer never waits for readers;
+// a reader detects an overwritten or torn slot by re-checking seq and drops that frame.
+namespace hogshm {
+
+constexpr uint32_t MAGIC = 0x52474F48; // "HOGR"
+constexpr uint32_t VERSION = 1;
+constexpr size_t ALIGNMENT = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared-memory atomics must be lock-free");
+
+struct alignas(ALIGNMENT) RingHeader {
+    std::atomic<uint32_t> magic;    // Written last by the producer: MAGIC once initialized
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t payloadCapacity;       // Floats per slot
+    uint64_t slotBytes;             // SlotHeader + payload, rounded to ALIGNMENT
+    std::atomic<uint64_t> lastSeq;  // Newest published frame number (0 = none yet)
+};
+
+struct alignas(ALIGNMENT) SlotHeader {
+    std::atomic<uint64_t> seq;
+    uint64_t frameId;     // Producer's frame index
+    int64_t timestampNs;  // steady_clock (CLOCK_MONOTONIC), comparable across processes
+    uint32_t cellsX;
+    uint32_t cellsY;
+    uint32_t bins;        // Valid bins per cell
+    uint32_t cellStride;  // Floats per cell (bins, or 16 for the padded layout)
+    uint32_t payloadFloats;
+};
+
+inline size_t alignUp(size_t n) { return (n + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+inline size_t slotBytesFor(uint32_t payloadFloats) { return alignUp(sizeof(SlotHeader) + payloadFloats * sizeof(float)); }
+inline size_t mappingBytes(uint32_t slotCount, size_t slotBytes) { return alignUp(sizeof(RingHeader)) + slotCount * slotBytes; }
+
+} // namespace hogshm
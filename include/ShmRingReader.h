@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ShmRing.h"
+
+// Consumer side of the descriptor ring (see ShmRing.h). Link against hog_shm_reader.
+//
+//   ShmRingReader reader("hog_descriptors");
+//   ShmRingReader::FrameView view;
+//   while (running) {
+//       if (!reader.acquire(view)) { /* nothing new */ continue; }
+//       use(view.data, view.cellsX, view.cellsY, view.cellStride); // Zero-copy, in shared memory
+//       if (!reader.validate(view)) { /* overwritten while in use: discard results */ }
+//   }
+class ShmRingReader {
+public:
+    struct FrameView {
+        uint64_t seq = 0;
+        uint64_t frameId = 0;
+        int64_t timestampNs = 0;
+        uint32_t cellsX = 0, cellsY = 0, bins = 0, cellStride = 0;
+        const float* data = nullptr; // cellsY rows of cellsX * cellStride floats
+    };
+
+    // Maps /dev/shm/<name> read-only. Throws std::runtime_error if it does not
+    // exist or is not an initialized ring. Starts at the newest frame.
+    explicit ShmRingReader(const std::string& name);
+    ~ShmRingReader();
+
+    ShmRingReader(const ShmRingReader&) = delete;
+    ShmRingReader& operator=(const ShmRingReader&) = delete;
+
+    // Points 'view' at the next unread frame. Skips (and counts) frames the
+    // producer has already overwritten. Returns false if no new frame is ready.
+    bool acquire(FrameView& view);
+
+    // True if the slot still holds the frame 'view' refers to, i.e. nothing read
+    // through view.data since acquire() was torn by the producer.
+    bool validate(const FrameView& view) const;
+
+    // Convenience: acquire + copy + validate. Returns false if no consistent frame was read.
+    bool readCopy(FrameView& meta, std::vector<float>& out);
+
+    uint64_t droppedFrames() const { return dropped; }
+
+private:
+    const hogshm::SlotHeader* slot(uint64_t seq) const;
+
+    void* base = nullptr;
+    size_t bytes = 0;
+    const hogshm::RingHeader* header = nullptr;
+    uint64_t nextSeq = 1;
+    uint64_t dropped = 0;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "HogLayout.h"
+#include "ShmRing.h"
+
+// Producer side of the descriptor ring (see ShmRing.h). Lock-free and wait-free:
+// publishing never blocks on consumers, slow consumers simply miss frames.
+class ShmRingWriter {
+public:
+    // Creates /dev/shm/<name>. Throws std::runtime_error on failure, including when the
+    // name already exists (a live producer, or a ring left by a crashed run) unless
+    // 'replaceExisting' allows unlinking it first.
+    ShmRingWriter(const std::string& name, uint32_t slotCount, uint32_t payloadCapacityFloats,
+                  bool replaceExisting = false);
+    ~ShmRingWriter(); // Unlinks the name; consumers keep their mapping until they close
+
+    ShmRingWriter(const ShmRingWriter&) = delete;
+    ShmRingWriter& operator=(const ShmRingWriter&) = delete;
+
+    // Copies the grid into the next slot. Returns false if it does not fit the slot capacity.
+    bool publish(uint64_t frameId, const HistogramGrid& grid, uint32_t bins);
+
+    uint32_t capacity() const { return header->payloadCapacity; }
+
+private:
+    std::string name;
+    void* base = nullptr;
+    size_t bytes = 0;
+    hogshm::RingHeader* header = nullptr;
+    uint64_t nextSeq = 1;
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+
+class HogDetector;
+
+// Builds a fresh detector for one worker.
+// Detectors keep per-instance scratch buffers, so every worker owns its own.
+using DetectorFactory = std::function<HogDetector*()>;
+
+// Multi-stream mode: N sources, one lightweight reader per source,
+// one shared worker pool serving the streams round-robin.
+class StreamServer {
+public:
+    StreamServer(DetectorFactory factory, int workerCount = 0);
+
+    void run(const std::vector<std::string>& sources);
+
+private:
+    DetectorFactory factory;
+    int workerCount;
+};
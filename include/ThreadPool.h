@@ -0,0 +1,41 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fixed-size pool: a FIFO of tasks served by N worker threads.
+class ThreadPool {
+public:
+    explicit ThreadPool(int threadCount = 0); // 0 = hardware_concurrency - 1
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Runs body(i) for every i in [begin, end), split into chunks.
+    // The calling thread takes chunks too, so this is safe to call from inside a pool task.
+    void parallelFor(int begin, int end, const std::function<void(int)>& body);
+
+    int size() const { return (int)workers.size(); }
+
+    // True on a worker thread of any ThreadPool. Code that would open its own OpenMP
+    // team checks this: the pool already keeps every core busy.
+    static bool inWorker();
+
+    // Process-wide pool shared by the task backend and the CPU async API (computeHOGAsync).
+    static ThreadPool& global();
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable taskReady;
+    bool stopping = false;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "StreamServer.h" // DetectorFactory
+
+struct TrainingOptions {
+    int negativesPerImage = 10; // Random windows drawn from every negative image
+    uint64_t seed = 42;         // Same seed + same directories = same windows
+    int threads = 0;            // Parallel workers (one detector each). 0 = all cores
+    std::string outputDir = "../results/training/";
+};
+
+// SVM training set: one 64x128 (Utils::WIN_WIDTH x WIN_HEIGHT) window per row.
+// Positives: every image of the positive directory, resized to the window size.
+// Negatives: random windows at several scales from every negative image, resized likewise.
+// Windows are processed in batches (parallel, one detector per worker) and streamed
+// to disk, so memory stays flat however many windows there are.
+//
+// <outputDir>/features.bin: MatrixHeader, then rows x cols float32, row-major
+//                           (block descriptor, see computeBlockDescriptor).
+// <outputDir>/labels.bin:   MatrixHeader (cols = 1), then rows int32 (+1 / -1).
+// 'rows' is written last: a file with rows = 0 is an interrupted run.
+class TrainingWindows {
+public:
+    static constexpr char FEATURES_MAGIC[8] = { 'H', 'O', 'G', 'M', 'A', 'T', '0', '1' };
+    static constexpr char LABELS_MAGIC[8] = { 'H', 'O', 'G', 'L', 'B', 'L', '0', '1' };
+
+    struct MatrixHeader {
+        char magic[8];
+        uint64_t rows;
+        uint32_t cols;
+        uint32_t reserved;
+    };
+
+    // Returns 0 on success.
+    static int extract(const DetectorFactory& factory, const std::string& positiveDir,
+                       const std::string& negativeDir, const TrainingOptions& options);
+};
@@ -2,14 +2,37 @@
 #include <opencv2/opencv.hpp>
 #include <string>
 #include <vector>
+#include "BenchmarkStats.h"
+#include "HogLayout.h"
 
 class HogDetector; 
 
-struct BenchmarkStats {
-    int frameId;
-    int width;
-    int height;
-    double timeMs;
+struct BenchmarkOptions {
+    // Per-frame latency budget in ms. 0 = off (always full quality).
+    double latencyBudgetMs = 0.0;
+
+    // Histogram memory layout under test. 'timeDescriptor' adds the block
+    // normalization consumer to the timed section so both layouts are compared end to end.
+    HistogramLayout layout = HistogramLayout::CellMajor;
+    bool timeDescriptor = false;
+
+    // Publishes every frame's histogram grid to this POSIX shared-memory ring
+    // (see ShmRingReader.h for consumers). Empty = off.
+    std::string shmName;
+    int shmSlots = 8;
+    // Largest frame (pixels) the ring slots must hold. Empty = sized from the first
+    // frame's grid; larger frames are then skipped.
+    cv::Size shmMaxFrame;
+    // Unlink an existing ring of the same name instead of refusing to start.
+    bool shmReplace = false;
+
+    // Coarse-to-fine cascade (see HogCascade.h): windows scoring below this share of the
+    // frame's best window skip the full-resolution pass. 0 = off.
+    double cascadeThreshold = 0.0;
+
+    // Result cache (see FrameCache.h): byte-identical frames reuse their histograms.
+    // Memory budget in MB. 0 = off.
+    int cacheBudgetMB = 0;
 };
 
 class Utils {
@@ -17,7 +40,6 @@ public:
     static const int WIN_WIDTH = 64;
     static const int WIN_HEIGHT = 128;
     static cv::VideoCapture openVideo(const std::string& source);
-    static void saveTimesToCSV(const std::string& filename, const std::vector<BenchmarkStats>& stats);
     static void saveFrame(const cv::Mat& resultImage, int frameId);
-    static void runBenchmarkTask(HogDetector* detector, const std::string& inputPath, const std::string& methodName, const std::string& outputFileName);
+    static void runBenchmarkTask(HogDetector* detector, const std::string& inputPath, const std::string& methodName, const std::string& outputFileName, const BenchmarkOptions& options = BenchmarkOptions());
 };
@@ -9,6 +9,14 @@ METHODS = [
     ("OpenMP Parallel", "OpenMP.csv"),
     ("CUDA GPU",        "CUDA.csv"),     
     ("OpenCL GPU",      "OpenCL.csv"),   
+    ("StdPar CPU",      "StdPar.csv"),
+    ("Tasks CPU",       "Tasks.csv"),
+    ("OpenCV Reference", "OpenCV.csv"),
+    # Histogram layout comparison (--layout both)
+    ("Sequential CellMajor", "Sequential_CellMajor.csv"),
+    ("Sequential Padded16",  "Sequential_Padded16.csv"),
+    ("OpenMP CellMajor",     "OpenMP_CellMajor.csv"),
+    ("OpenMP Padded16",      "OpenMP_Padded16.csv"),
 ]
 
 def get_file_path(filename):
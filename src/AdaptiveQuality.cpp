@@ -0,0 +1,111 @@
+#include "../include/AdaptiveQuality.h"
+#include "../include/HogDetector.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace cv;
+using namespace std;
+
+// --- Tuning Constants ---
+// Smoothing gains of the running estimate (same as a TCP RTT estimator).
+static constexpr double MEAN_GAIN = 1.0 / 8.0;
+static constexpr double DEV_GAIN = 1.0 / 4.0;
+// Deviations added to the mean: we budget for the tail (p99), not the average.
+static constexpr double TAIL_FACTOR = 3.0;
+// Initial deviation of a level's estimate, as a share of its first sample. Small, so one
+// sample does not predict a tail far above itself (mean + 3 * ms / 2 would be 2.5x).
+static constexpr double INITIAL_DEV_SHARE = 1.0 / 8.0;
+// Only try a better level when the current one uses less than this share of the budget...
+static constexpr double HEADROOM = 0.6;
+// ...for this many frames in a row. Doubles after each failed try, up to the cap.
+static constexpr int PROBE_INTERVAL = 30;
+static constexpr int PROBE_INTERVAL_MAX = 960;
+
+double AdaptiveQuality::Estimate::predicted() const {
+    return mean + TAIL_FACTOR * dev;
+}
+
+AdaptiveQuality::AdaptiveQuality(double budgetMs, const HogDetector* detector)
+    : budgetMs(budgetMs),
+      grayscaleSupported(detector && detector->supportsGrayscale()),
+      probeInterval(PROBE_INTERVAL) {}
+
+bool AdaptiveQuality::supported(int lvl) const {
+    return lvl != QUALITY_LUMA || grayscaleSupported;
+}
+
+int AdaptiveQuality::cheaper(int lvl) const {
+    for (int l = lvl + 1; l < QUALITY_LEVEL_COUNT; l++) if (supported(l)) return l;
+    return lvl;
+}
+
+int AdaptiveQuality::better(int lvl) const {
+    for (int l = lvl - 1; l >= 0; l--) if (supported(l)) return l;
+    return lvl;
+}
+
+void AdaptiveQuality::prepareFrame(const Mat& input, HogDetector* detector, Mat& output) const {
+    detector->setRowStep(level >= QUALITY_ROW_SKIP ? 2 : 1);
+
+    Mat src = input;
+    if (level >= QUALITY_LUMA && grayscaleSupported && input.channels() == 3) {
+        cvtColor(input, output, COLOR_BGR2GRAY);
+        src = output;
+    }
+    if (level >= QUALITY_HALF_RES) {
+        Mat small;
+        resize(src, small, Size(src.cols / 2, src.rows / 2), 0, 0, INTER_LINEAR);
+        output = small;
+    } else {
+        output = src;
+    }
+}
+
+void AdaptiveQuality::record(double ms) {
+    Estimate& e = estimates[level];
+    bool firstSample = !e.valid;
+    if (firstSample) {
+        e.mean = ms;
+        e.dev = ms * INITIAL_DEV_SHARE;
+        e.valid = true;
+    } else {
+        e.dev += DEV_GAIN * (std::abs(ms - e.mean) - e.dev);
+        e.mean += MEAN_GAIN * (ms - e.mean);
+    }
+
+    // 1. Over budget: step down right away. A single sample says nothing about the
+    //    tail yet, so on the first one only an actual miss counts.
+    if (ms > budgetMs || (!firstSample && e.predicted() > budgetMs)) {
+        int next = cheaper(level);
+        if (probing) probeInterval = std::min(probeInterval * 2, PROBE_INTERVAL_MAX);
+        probing = false;
+        calmFrames = 0;
+        if (next != level) level = next;
+        return;
+    }
+
+    // A probe that survived a full interval is a success.
+    if (probing && ++calmFrames >= probeInterval) {
+        probing = false;
+        probeInterval = PROBE_INTERVAL;
+        calmFrames = 0;
+    }
+    if (probing) return;
+
+    // 2. Plenty of headroom for a while: try one level up.
+    int up = better(level);
+    if (up == level) return;
+
+    if (e.predicted() < budgetMs * HEADROOM) calmFrames++;
+    else calmFrames = 0;
+
+    const Estimate& target = estimates[up];
+    bool fits = !target.valid || target.predicted() <= budgetMs;
+    // Estimates of levels we have left may be stale (e.g. a transient load spike),
+    // so after a long calm period we retry them anyway.
+    if ((fits && calmFrames >= PROBE_INTERVAL) || calmFrames >= probeInterval) {
+        level = up;
+        probing = true;
+        calmFrames = 0;
+    }
+}
@@ -0,0 +1,247 @@
+#include "../include/BackendComparison.h"
+#include "../include/HogDetector.h"
+#include "../include/Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+using namespace cv;
+using namespace std;
+namespace fs = std::filesystem;
+
+// ==========================================
+// CONFIGURATION
+// ==========================================
+// Frames kept in memory and fed to every backend.
+static constexpr int COMPARE_FRAMES = 200;
+
+// Single images are repeated so the timing is not dominated by warm-up.
+static constexpr int IMAGE_REPEATS = 50;
+
+// Detection-window case: every frame is also resized to one 64x128 window, the geometry
+// of --train-windows (and of cv::HOGDescriptor's default window).
+static const cv::Size WINDOW_SIZE(64, 128);
+// ==========================================
+
+namespace {
+    struct AccuracyStats {
+        double sumAbs = 0.0;
+        double maxAbs = 0.0;
+        double sumCosine = 0.0;
+        long long bins = 0;
+        long long cells = 0;
+        int mismatchedFrames = 0;
+    };
+
+    vector<Mat> loadFrames(const string& inputPath) {
+        vector<Mat> frames;
+        bool isCamera = inputPath.size() == 1 && isdigit(inputPath[0]);
+        string ext = fs::path(inputPath).extension().string();
+
+        if (isCamera || ext == ".mp4" || ext == ".avi" || ext == ".mov") {
+            VideoCapture cap = Utils::openVideo(inputPath);
+            Mat frame;
+            while ((int)frames.size() < COMPARE_FRAMES && cap.read(frame) && !frame.empty()) {
+                frames.push_back(frame.clone());
+            }
+        } else if (fs::is_directory(inputPath)) {
+            vector<string> files;
+            for (const auto& entry : fs::directory_iterator(inputPath)) {
+                string e = entry.path().extension().string();
+                if (e == ".jpg" || e == ".png" || e == ".jpeg" || e == ".bmp") files.push_back(entry.path().string());
+            }
+            sort(files.begin(), files.end());
+            for (const auto& f : files) {
+                if ((int)frames.size() >= COMPARE_FRAMES) break;
+                Mat img = imread(f);
+                if (!img.empty()) frames.push_back(img);
+            }
+        } else {
+            Mat img = imread(inputPath);
+            if (!img.empty()) frames.assign(IMAGE_REPEATS, img);
+        }
+        return frames;
+    }
+
+    // Per-cell L2-Hys, using the same constants as cv::HOGDescriptor, so our raw
+    // histograms can be compared with the reference on the same scale.
+    void normalizeCell(const float* in, float* out) {
+        constexpr int BINS = HogDetector::BIN_COUNT;
+        float sum = 0.0f;
+        for (int b = 0; b < BINS; b++) sum += in[b] * in[b];
+        float scale = 1.0f / (std::sqrt(sum) + BINS * 0.1f);
+
+        float sum2 = 0.0f;
+        for (int b = 0; b < BINS; b++) {
+            out[b] = std::min(in[b] * scale, 0.2f);
+            sum2 += out[b] * out[b];
+        }
+        float scale2 = 1.0f / (std::sqrt(sum2) + 1e-3f);
+        for (int b = 0; b < BINS; b++) out[b] *= scale2;
+    }
+
+    // Copies a grid into a dense, per-cell normalized buffer.
+    void normalizedCells(const HistogramGrid& grid, bool alreadyNormalized, vector<float>& out) {
+        constexpr int BINS = HogDetector::BIN_COUNT;
+        out.resize((size_t)grid.cellsX * grid.cellsY * BINS);
+        for (int cy = 0; cy < grid.cellsY; cy++) {
+            for (int cx = 0; cx < grid.cellsX; cx++) {
+                float* dst = &out[((size_t)cy * grid.cellsX + cx) * BINS];
+                if (alreadyNormalized) std::copy(grid.cell(cx, cy), grid.cell(cx, cy) + BINS, dst);
+                else normalizeCell(grid.cell(cx, cy), dst);
+            }
+        }
+    }
+}
+
+void BackendComparison::run(const vector<ComparedBackend>& backends, const string& inputPath) {
+    constexpr int BINS = HogDetector::BIN_COUNT;
+    cout << "\n=== Running Backend Comparison (" << backends.size() << " backends) ===" << endl;
+    if (backends.size() < 2) {
+        cerr << "[Error] Need a reference and at least one backend to compare." << endl;
+        return;
+    }
+
+    vector<Mat> frames = loadFrames(inputPath);
+    if (frames.empty()) {
+        cerr << "[Error] No frames could be read from: " << inputPath << endl;
+        return;
+    }
+    cout << "[Info] " << frames.size() << " identical frames per backend. Reference: " << backends[0].name << endl;
+
+    // --- 1. Throughput (each backend alone, after one warm-up frame) ---
+    vector<double> avgMs(backends.size(), 0.0);
+    for (size_t b = 0; b < backends.size(); b++) {
+        HogDetector* d = backends[b].detector;
+        d->computeHOG(frames[0], false);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const auto& f : frames) d->computeHOG(f, false);
+        auto end = std::chrono::high_resolution_clock::now();
+        avgMs[b] = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0 / frames.size();
+    }
+
+    // --- 2. Accuracy (per cell, against the reference) ---
+    vector<float> ref, cur;
+
+    // 'firstFrameDiff' (optional) receives the per-cell L1 distances of frame 0
+    auto measureAccuracy = [&](const vector<Mat>& inputs, vector<AccuracyStats>& acc,
+                               vector<vector<float>>* firstFrameDiff, Size* firstGrid) {
+        for (size_t f = 0; f < inputs.size(); f++) {
+            backends[0].detector->computeHOG(inputs[f], false);
+            HistogramGrid refGrid = backends[0].detector->getHistogramGrid();
+            normalizedCells(refGrid, true, ref);
+            if (f == 0 && firstGrid) *firstGrid = Size(refGrid.cellsX, refGrid.cellsY);
+
+            for (size_t b = 1; b < backends.size(); b++) {
+                backends[b].detector->computeHOG(inputs[f], false);
+                HistogramGrid grid = backends[b].detector->getHistogramGrid();
+                if (grid.empty() || grid.cellsX != refGrid.cellsX || grid.cellsY != refGrid.cellsY) {
+                    acc[b].mismatchedFrames++;
+                    continue;
+                }
+                normalizedCells(grid, false, cur);
+
+                AccuracyStats& a = acc[b];
+                size_t cellCount = (size_t)grid.cellsX * grid.cellsY;
+                bool keepCells = (f == 0 && firstFrameDiff);
+                if (keepCells) (*firstFrameDiff)[b].resize(cellCount);
+
+                for (size_t c = 0; c < cellCount; c++) {
+                    const float* r = &ref[c * BINS];
+                    const float* v = &cur[c * BINS];
+                    double l1 = 0.0, dot = 0.0, nr = 0.0, nv = 0.0;
+                    for (int k = 0; k < BINS; k++) {
+                        double d = std::abs(r[k] - v[k]);
+                        l1 += d;
+                        a.maxAbs = std::max(a.maxAbs, d);
+                        dot += r[k] * v[k];
+                        nr += r[k] * r[k];
+                        nv += v[k] * v[k];
+                    }
+                    a.sumAbs += l1;
+                    a.bins += BINS;
+                    // Two empty cells are identical
+                    a.sumCosine += (nr > 0.0 && nv > 0.0) ? dot / std::sqrt(nr * nv) : ((nr == nv) ? 1.0 : 0.0);
+                    a.cells++;
+                    if (keepCells) (*firstFrameDiff)[b][c] = (float)l1;
+                }
+            }
+        }
+    };
+
+    vector<AccuracyStats> acc(backends.size());
+    vector<vector<float>> firstFrameDiff(backends.size());
+    Size firstGrid;
+    measureAccuracy(frames, acc, &firstFrameDiff, &firstGrid);
+
+    // Same frames as single detection windows: the grid size OpenCV's defaults also use
+    vector<Mat> windows(frames.size());
+    for (size_t f = 0; f < frames.size(); f++) resize(frames[f], windows[f], WINDOW_SIZE, 0, 0, INTER_AREA);
+    vector<AccuracyStats> windowAcc(backends.size());
+    measureAccuracy(windows, windowAcc, nullptr, nullptr);
+    windows.clear();
+
+    // --- 3. Report ---
+    string outputDir = "../results/";
+    if (!fs::exists(outputDir)) fs::create_directories(outputDir);
+    ofstream csv(outputDir + "Comparison.csv");
+    csv << "Input,Backend,Avg_ms,FPS,MeanAbsDiff,MaxAbsDiff,MeanCosine,MismatchedFrames\n";
+
+    // Timing columns only for the full frames; the window pass checks accuracy only
+    auto report = [&](const string& input, const vector<AccuracyStats>& accuracy, bool timed) {
+        cout << "--- " << input << " ---" << endl;
+        cout << left << setw(20) << "Backend" << right;
+        if (timed) cout << setw(12) << "Avg ms" << setw(10) << "FPS" << setw(12) << "Speedup";
+        cout << setw(14) << "MeanAbsDiff" << setw(12) << "MaxAbsDiff" << setw(12) << "MeanCosine" << endl;
+
+        for (size_t b = 0; b < backends.size(); b++) {
+            const AccuracyStats& a = accuracy[b];
+            double ms = timed ? avgMs[b] : 0.0;
+            double fps = ms > 0.0 ? 1000.0 / ms : 0.0;
+            double speedup = ms > 0.0 ? avgMs[0] / ms : 0.0;
+            bool isRef = (b == 0);
+            double meanAbs = a.bins ? a.sumAbs / a.bins : 0.0;
+            double meanCos = a.cells ? a.sumCosine / a.cells : (isRef ? 1.0 : 0.0);
+
+            cout << left << setw(20) << backends[b].name << right << fixed;
+            if (timed) {
+                cout << setprecision(3) << setw(12) << ms << setw(10) << setprecision(1) << fps
+                     << setw(11) << setprecision(2) << speedup << "x";
+            }
+            if (isRef) cout << setw(14) << "(reference)";
+            else cout << setprecision(4) << setw(14) << meanAbs << setw(12) << a.maxAbs << setw(12) << meanCos;
+            if (a.mismatchedFrames) cout << "  [" << a.mismatchedFrames << " frames with a different grid]";
+            cout << defaultfloat << endl;
+
+            csv << input << "," << backends[b].name << "," << ms << "," << fps << "," << meanAbs << ","
+                << a.maxAbs << "," << meanCos << "," << a.mismatchedFrames << "\n";
+        }
+    };
+
+    report("Frames", acc, true);
+    report("Window" + to_string(WINDOW_SIZE.width) + "x" + to_string(WINDOW_SIZE.height), windowAcc, false);
+    cout << "[Saved] Summary to " << outputDir << "Comparison.csv" << endl;
+
+    // Per-cell L1 distance to the reference on the first frame, one column per backend
+    ofstream cells(outputDir + "Comparison_Cells.csv");
+    cells << "CellX,CellY";
+    for (size_t b = 1; b < backends.size(); b++) cells << "," << backends[b].name;
+    cells << "\n";
+    for (int cy = 0; cy < firstGrid.height; cy++) {
+        for (int cx = 0; cx < firstGrid.width; cx++) {
+            size_t c = (size_t)cy * firstGrid.width + cx;
+            cells << cx << "," << cy;
+            for (size_t b = 1; b < backends.size(); b++) {
+                cells << ",";
+                if (c < firstFrameDiff[b].size()) cells << firstFrameDiff[b][c];
+            }
+            cells << "\n";
+        }
+    }
+    cout << "[Saved] Per-cell differences (frame 0) to " << outputDir << "Comparison_Cells.csv" << endl;
+}
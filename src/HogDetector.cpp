@@ -0,0 +1,82 @@
+#include "../include/HogDetector.h"
+#include "../include/ThreadPool.h"
+
+using namespace cv;
+using namespace std;
+
+future<HogResult> HogDetector::computeHOGAsync(const Mat& input, bool visualize, HogCallback onComplete) {
+    AsyncJob job;
+    job.input = input;
+    job.visualize = visualize;
+    job.onComplete = std::move(onComplete);
+    future<HogResult> result = job.promise.get_future();
+
+    bool startDrain = false;
+    {
+        lock_guard<mutex> lk(asyncLock);
+        asyncQueue.push_back(std::move(job));
+        asyncInFlight++;
+        if (!asyncDraining) {
+            asyncDraining = true;
+            startDrain = true;
+        }
+    }
+    // One drain task at a time per detector: frames complete in submission order
+    if (startDrain) ThreadPool::global().submit([this] { drainAsyncQueue(); });
+    return result;
+}
+
+void HogDetector::drainAsyncQueue() {
+    unique_lock<mutex> lk(asyncLock);
+    while (!asyncQueue.empty()) {
+        AsyncJob job = std::move(asyncQueue.front());
+        asyncQueue.pop_front();
+        lk.unlock();
+
+        try {
+            HogResult result;
+            result.visual = computeHOG(job.input, job.visualize);
+            copyToResult(getHistogramGrid(), result);
+            if (job.onComplete) job.onComplete(result);
+            job.promise.set_value(std::move(result));
+        } catch (...) {
+            job.promise.set_exception(current_exception());
+        }
+
+        lk.lock();
+        asyncInFlight--;
+    }
+    asyncDraining = false;
+    // Notify under the lock and touch nothing after it is released:
+    // the owner may be waiting in waitForPending() to destroy the detector.
+    asyncIdle.notify_all();
+}
+
+void HogDetector::waitForPending() {
+    unique_lock<mutex> lk(asyncLock);
+    asyncIdle.wait(lk, [this] { return asyncInFlight == 0 && !asyncDraining; });
+}
+
+void HogDetector::asyncStarted() {
+    lock_guard<mutex> lk(asyncLock);
+    asyncInFlight++;
+}
+
+void HogDetector::asyncFinished() {
+    // Notify under the lock: once it is released the detector may be destroyed
+    lock_guard<mutex> lk(asyncLock);
+    if (--asyncInFlight == 0) asyncIdle.notify_all();
+}
+
+void HogDetector::copyToResult(const HistogramGrid& grid, HogResult& result) {
+    result.gridSize = Size(grid.cellsX, grid.cellsY);
+    result.cellHistograms.resize((size_t)grid.cellsX * grid.cellsY * BIN_COUNT);
+    float* dst = result.cellHistograms.data();
+    for (int cy = 0; cy < grid.cellsY; cy++) {
+        for (int cx = 0; cx < grid.cellsX; cx++) {
+            const float* cell = grid.cell(cx, cy);
+            std::copy(cell, cell + BIN_COUNT, dst);
+            dst += BIN_COUNT;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#include "../include/HogLayout.h"
+#include "../include/HogDetector.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// --- Tuning Constants ---
+static constexpr float L2HYS_CLIP = 0.2f;
+static constexpr float NORM_EPS = 1e-6f;
+static constexpr int BINS = HogDetector::BIN_COUNT;
+static constexpr int BLOCK_FLOATS = 4 * BINS;
+
+// 'Width' is the number of floats read per cell. For the padded layout it is the full
+// 16-float cell: the padding is zero, so it does not change the sums, and the fixed
+// aligned width lets the compiler emit whole-register loads with no masked tail.
+template <int Width>
+static void normalizeBlocks(const HistogramGrid& grid, float* out) {
+    for (int by = 0; by < grid.cellsY - 1; by++) {
+        for (int bx = 0; bx < grid.cellsX - 1; bx++) {
+            const float* cells[4] = {
+                grid.cell(bx, by),     grid.cell(bx + 1, by),
+                grid.cell(bx, by + 1), grid.cell(bx + 1, by + 1)
+            };
+
+            // 1. L2 norm
+            float sumSq = 0.0f;
+            for (int k = 0; k < 4; k++) {
+                for (int i = 0; i < Width; i++) sumSq += cells[k][i] * cells[k][i];
+            }
+            float inv = 1.0f / std::sqrt(sumSq + NORM_EPS);
+
+            // 2. Clip, then renormalize (Hys)
+            float clipped[4][Width];
+            float sumSq2 = 0.0f;
+            for (int k = 0; k < 4; k++) {
+                for (int i = 0; i < Width; i++) {
+                    float v = std::min(cells[k][i] * inv, L2HYS_CLIP);
+                    clipped[k][i] = v;
+                    sumSq2 += v * v;
+                }
+            }
+            float inv2 = 1.0f / std::sqrt(sumSq2 + NORM_EPS);
+
+            // 3. Dense output: 4 cells x BINS
+            for (int k = 0; k < 4; k++) {
+                for (int b = 0; b < BINS; b++) out[k * BINS + b] = clipped[k][b] * inv2;
+            }
+            out += BLOCK_FLOATS;
+        }
+    }
+}
+
+void computeBlockDescriptor(const HistogramGrid& grid, vector<float>& descriptor) {
+    if (grid.empty() || grid.cellsX < 2 || grid.cellsY < 2) {
+        descriptor.clear();
+        return;
+    }
+    descriptor.resize((size_t)(grid.cellsX - 1) * (grid.cellsY - 1) * BLOCK_FLOATS);
+
+    if (grid.cellStride == PADDED_CELL_STRIDE) normalizeBlocks<PADDED_CELL_STRIDE>(grid, descriptor.data());
+    else normalizeBlocks<BINS>(grid, descriptor.data());
+}
@@ -0,0 +1,179 @@
+#include "../include/HogVisualizer.h"
+#include "../include/HogDetector.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+// ==========================================
+// CONFIGURATION
+// ==========================================
+// Brightness of the background image under the glyphs.
+static constexpr float VIS_SCALE = 0.3f;
+
+// Bins weaker than this share of the frame maximum are not drawn.
+static constexpr float MIN_STRENGTH = 0.05f;
+
+// Half stroke length at full strength, in pixels.
+static constexpr float MAX_HALF_LENGTH = (HogDetector::CELL_WIDTH / 2) * 2.5f;
+// ==========================================
+
+namespace {
+    constexpr int BINS = HogDetector::BIN_COUNT;
+    constexpr int CELL_W = HogDetector::CELL_WIDTH;
+    constexpr int CELL_H = HogDetector::CELL_HEIGHT;
+    constexpr int GLYPH = HogVisualizer::GLYPH_SIZE;
+    constexpr int LEVELS = HogVisualizer::STRENGTH_LEVELS;
+
+    // Sprite origin relative to the cell origin (sprites are centred on the cell centre)
+    constexpr int GLYPH_OFFSET_X = CELL_W / 2 - GLYPH / 2;
+    constexpr int GLYPH_OFFSET_Y = CELL_H / 2 - GLYPH / 2;
+
+    // The 3-phase row schedule below relies on sprites reaching at most one cell row away
+    static_assert(-GLYPH_OFFSET_Y <= CELL_H && GLYPH + GLYPH_OFFSET_Y <= 2 * CELL_H,
+                  "Glyph sprites must not reach beyond the neighbouring cell rows");
+    static_assert(2 * MAX_HALF_LENGTH < GLYPH, "Strokes must fit inside the sprite");
+
+    struct GlyphPixel {
+        int8_t dx, dy; // Relative to the sprite origin
+        uchar alpha;
+    };
+
+    // Sparse sprites: a stroke covers ~5% of its box, so only lit pixels are stored.
+    struct GlyphAtlas {
+        vector<GlyphPixel> glyphs[BINS][LEVELS];
+        uchar color[LEVELS][3]; // BGR per strength level
+        uchar darken[256];      // Background LUT
+
+        GlyphAtlas() {
+            float radPerBin = (float)(CV_PI / 180.0) * (180.0f / BINS);
+            Mat canvas(GLYPH, GLYPH, CV_8UC1);
+            Point2f centre(GLYPH / 2.0f, GLYPH / 2.0f);
+
+            for (int level = 0; level < LEVELS; level++) {
+                float strength = (level + 1) / (float)LEVELS; // Top of the bucket: full strength = 1
+                color[level][0] = 0;
+                color[level][1] = saturate_cast<uchar>(255 * strength);
+                color[level][2] = 255;
+
+                float len = MAX_HALF_LENGTH * strength;
+                for (int b = 0; b < BINS; b++) {
+                    float angle = b * radPerBin;
+                    Point2f d(std::cos(angle) * len, std::sin(angle) * len);
+
+                    // 4 fractional bits keep the sub-pixel end points of the stroke
+                    constexpr int SHIFT = 4;
+                    constexpr float ONE = 1 << SHIFT;
+                    canvas.setTo(Scalar(0));
+                    line(canvas, Point(cvRound((centre.x - d.x) * ONE), cvRound((centre.y - d.y) * ONE)),
+                         Point(cvRound((centre.x + d.x) * ONE), cvRound((centre.y + d.y) * ONE)),
+                         Scalar(255), 1, LINE_AA, SHIFT);
+
+                    for (int y = 0; y < GLYPH; y++) {
+                        const uchar* row = canvas.ptr<uchar>(y);
+                        for (int x = 0; x < GLYPH; x++) {
+                            if (row[x]) glyphs[b][level].push_back({ (int8_t)x, (int8_t)y, row[x] });
+                        }
+                    }
+                }
+            }
+            for (int v = 0; v < 256; v++) darken[v] = saturate_cast<uchar>(v * VIS_SCALE);
+        }
+    };
+
+    const GlyphAtlas& atlas() {
+        static const GlyphAtlas instance; // Built once, thread-safe
+        return instance;
+    }
+
+    // Darkens (and expands to BGR) pixel rows [y0, y1) of 'image' into 'output'.
+    void darkenRows(const Mat& image, Mat& output, int y0, int y1, const uchar* lut) {
+        int cols = image.cols;
+        int cn = image.channels();
+        for (int y = y0; y < y1; y++) {
+            const uchar* src = image.ptr<uchar>(y);
+            uchar* dst = output.ptr<uchar>(y);
+            if (cn == 3) {
+                for (int i = 0; i < cols * 3; i++) dst[i] = lut[src[i]];
+            } else {
+                for (int x = 0; x < cols; x++) {
+                    uchar v = lut[src[x * cn]];
+                    dst[3 * x] = v;
+                    dst[3 * x + 1] = v;
+                    dst[3 * x + 2] = v;
+                }
+            }
+        }
+    }
+
+    // Blends the glyphs of cell row 'cy' (they reach into rows cy - 1 .. cy + 1).
+    void blitCellRow(const HistogramGrid& grid, int cy, float invMax, Mat& output, const GlyphAtlas& a) {
+        int rows = output.rows;
+        int cols = output.cols;
+        int originY = cy * CELL_H + GLYPH_OFFSET_Y;
+
+        for (int cx = 0; cx < grid.cellsX; cx++) {
+            const float* cell = grid.cell(cx, cy);
+            int originX = cx * CELL_W + GLYPH_OFFSET_X;
+            bool inside = originX >= 0 && originY >= 0 && originX + GLYPH <= cols && originY + GLYPH <= rows;
+
+            for (int b = 0; b < BINS; b++) {
+                float strength = cell[b] * invMax;
+                if (strength < MIN_STRENGTH) continue;
+                int level = std::min(LEVELS - 1, (int)(strength * LEVELS));
+                const uchar* color = a.color[level];
+
+                for (const GlyphPixel& p : a.glyphs[b][level]) {
+                    int x = originX + p.dx;
+                    int y = originY + p.dy;
+                    if (!inside && (x < 0 || y < 0 || x >= cols || y >= rows)) continue;
+
+                    uchar* px = output.ptr<uchar>(y) + 3 * x;
+                    int alpha = p.alpha;
+                    for (int c = 0; c < 3; c++) px[c] = (uchar)(px[c] + ((color[c] - px[c]) * alpha + 127) / 255);
+                }
+            }
+        }
+    }
+}
+
+void HogVisualizer::render(const HistogramGrid& grid, const Mat& image, Mat& output, bool parallel) {
+    const GlyphAtlas& a = atlas();
+    output.create(image.size(), CV_8UC3);
+    if (image.empty()) return;
+    // One OpenMP team per pool worker would oversubscribe the CPU N-fold
+    parallel = parallel && !ThreadPool::inWorker();
+
+    float maxVal = 0.0f;
+    #pragma omp parallel for reduction(max:maxVal) schedule(static) if(parallel)
+    for (int cy = 0; cy < grid.cellsY; cy++) {
+        for (int cx = 0; cx < grid.cellsX; cx++) {
+            const float* cell = grid.cell(cx, cy);
+            for (int b = 0; b < BINS; b++) maxVal = std::max(maxVal, cell[b]);
+        }
+    }
+    float invMax = 1.0f / (maxVal > 0.0f ? maxVal : 1.0f);
+
+    // Cell rows of one phase are 3 apart, so their sprites never touch the same pixels.
+    // Phase 0 also darkens the pixel bands of rows cy - 1 .. cy + 1 right before blitting:
+    // those bands tile the image, and later phases only blend on top of them.
+    int bands = (image.rows + CELL_H - 1) / CELL_H; // Includes a partial last band
+    int limit = bands + 1; // Exclusive: the last band may only be reached as 'cy - 1'
+    for (int phase = 0; phase < 3; phase++) {
+        int count = (limit - phase + 2) / 3;
+
+        #pragma omp parallel for schedule(dynamic, 1) if(parallel)
+        for (int i = 0; i < count; i++) {
+            int cy = phase + 3 * i;
+            if (phase == 0) {
+                int y0 = std::max(0, (cy - 1) * CELL_H);
+                int y1 = std::min(image.rows, (cy + 2) * CELL_H);
+                if (y0 < y1) darkenRows(image, output, y0, y1, a.darken);
+            }
+            if (cy < grid.cellsY) blitCellRow(grid, cy, invMax, output, a);
+        }
+    }
+}
@@ -0,0 +1,192 @@
+#include "../include/LatencyRecorder.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// ==========================================
+// CONFIGURATION
+// ==========================================
+// Rows buffered between record() and the writer thread (~7 s of frames at 1000 fps).
+static constexpr size_t LOG_QUEUE_CAPACITY = 8192;
+
+// How often the writer hands its buffer to the OS (= rows lost at most on a crash).
+static constexpr int FLUSH_INTERVAL_MS = 250;
+
+// Writer poll period when the queue is empty (the producer never signals, to stay lock-free).
+static constexpr int WRITER_IDLE_SLEEP_MS = 5;
+// ==========================================
+
+// --- LatencyHistogram ---
+
+// Bucket layout: [0, SUB_BUCKETS) exact, then per magnitude m >= 1 the values
+// [sub << m, (sub + 1) << m) for sub in [SUB_BUCKETS / 2, SUB_BUCKETS).
+int LatencyHistogram::bucketIndex(uint64_t us) {
+    if (us < (uint64_t)SUB_BUCKETS) return (int)us;
+    int msb = 63 - __builtin_clzll(us);
+    int magnitude = msb - SUB_BUCKET_BITS + 1;
+    int sub = (int)(us >> magnitude);
+    return SUB_BUCKETS + (magnitude - 1) * (SUB_BUCKETS / 2) + (sub - SUB_BUCKETS / 2);
+}
+
+uint64_t LatencyHistogram::bucketUpper(int index) {
+    if (index < SUB_BUCKETS) return (uint64_t)index;
+    int k = index - SUB_BUCKETS;
+    int magnitude = k / (SUB_BUCKETS / 2) + 1;
+    uint64_t sub = (uint64_t)(k % (SUB_BUCKETS / 2) + SUB_BUCKETS / 2);
+    return ((sub + 1) << magnitude) - 1;
+}
+
+void LatencyHistogram::record(double ms) {
+    double us = std::max(0.0, ms * 1000.0);
+    uint64_t v = us >= (double)MAX_US ? MAX_US : (uint64_t)std::llround(us);
+    counts[bucketIndex(v)]++;
+    total++;
+    sumMs += ms;
+    maxUs = std::max(maxUs, v);
+}
+
+void LatencyHistogram::reset() {
+    counts.fill(0);
+    total = 0;
+    sumMs = 0.0;
+    maxUs = 0;
+}
+
+double LatencyHistogram::percentile(double p) const {
+    if (total == 0) return 0.0;
+    uint64_t rank = (uint64_t)std::ceil(std::min(100.0, std::max(0.0, p)) / 100.0 * total);
+    rank = std::max<uint64_t>(1, rank);
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(bucketUpper(i), maxUs) / 1000.0;
+    }
+    return maxMs();
+}
+
+// --- CsvLogWriter ---
+
+CsvLogWriter::CsvLogWriter(const string& csvName, const string& header, const string& description)
+    : csvName(csvName), header(header), description(description) {}
+
+CsvLogWriter::~CsvLogWriter() {
+    finish();
+}
+
+size_t CsvLogWriter::queueCapacity() {
+    return LOG_QUEUE_CAPACITY;
+}
+
+bool CsvLogWriter::start() {
+    if (csvName.empty()) return false;
+
+    string outputDir = "../results/";
+    if (!fs::exists(outputDir)) fs::create_directories(outputDir);
+    csvPath = outputDir + csvName;
+    log.open(csvPath);
+    if (!log.is_open()) {
+        cerr << "[Error] Cannot write " << csvPath << ", " << description << " log disabled." << endl;
+        return false;
+    }
+    log << header << "\n";
+
+    writer = thread(&CsvLogWriter::writerLoop, this);
+    return true;
+}
+
+void CsvLogWriter::finish() {
+    if (!writer.joinable()) return;
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+    log.close();
+
+    cout << "[Saved] " << description << " to " << csvPath << endl;
+    if (droppedRows) {
+        cerr << "[Warning] " << droppedRows << " rows dropped from " << csvPath << " (log writer fell behind); "
+             << "the summaries still include them." << endl;
+    }
+}
+
+void CsvLogWriter::writerLoop() {
+    Clock::time_point lastFlush = Clock::now();
+    while (true) {
+        bool wrote = drainRows(log);
+
+        Clock::time_point now = Clock::now();
+        if (now - lastFlush >= std::chrono::milliseconds(FLUSH_INTERVAL_MS)) {
+            log.flush();
+            lastFlush = now;
+        }
+
+        if (!wrote) {
+            // Rows pushed before finish() are visible once 'stopping' is: drain them, then stop
+            if (stopping.load(std::memory_order_acquire)) {
+                drainRows(log);
+                break;
+            }
+            this_thread::sleep_for(std::chrono::milliseconds(WRITER_IDLE_SLEEP_MS));
+        }
+    }
+    log.flush();
+}
+
+// --- LatencyRecorder ---
+
+LatencyRecorder::LatencyRecorder(const string& label, const string& csvName, double summaryIntervalSec)
+    : label(label), summaryIntervalMs(summaryIntervalSec * 1000.0),
+      log(csvName, "Frame,Width,Height,Time_ms,Quality,Hash_ms,CacheHit", "Stats", &LatencyRecorder::writeRow) {}
+
+void LatencyRecorder::writeRow(ostream& out, const BenchmarkStats& s) {
+    out << s.frameId << "," << s.width << "," << s.height << "," << s.timeMs << "," << s.quality << ","
+        << s.hashMs << "," << s.cacheHit << "\n";
+}
+
+void LatencyRecorder::record(const BenchmarkStats& s) {
+    Clock::time_point now = Clock::now();
+    if (sums.frames == 0) {
+        windowStart = now;
+        windowFirstFrame = s.frameId;
+    }
+
+    total.record(s.timeMs);
+    window.record(s.timeMs);
+
+    sums.frames++;
+    sums.totalMs += s.timeMs;
+    sums.hashMs += s.hashMs;
+    if (s.cacheHit) {
+        sums.cacheHits++;
+        sums.cacheHitMs += s.timeMs;
+    }
+    if (budgetMs > 0.0 && s.timeMs > budgetMs) sums.overBudget++;
+    if (s.quality >= 0 && s.quality < RecorderTotals::MAX_QUALITY_LEVELS) sums.perQuality[s.quality]++;
+
+    log.push(s);
+
+    if (summaryIntervalMs > 0.0) {
+        double elapsedMs = std::chrono::duration_cast<std::chrono::microseconds>(now - windowStart).count() / 1000.0;
+        if (elapsedMs >= summaryIntervalMs) {
+            printWindow(elapsedMs);
+            window.reset();
+            windowStart = now;
+            windowFirstFrame = s.frameId + 1;
+        }
+    }
+}
+
+// One line per interval instead of one per frame
+void LatencyRecorder::printWindow(double elapsedMs) {
+    uint64_t n = window.count();
+    cout << "[Stats] " << label << " | frames " << windowFirstFrame << "-" << windowFirstFrame + (int)n - 1
+         << std::fixed << std::setprecision(1) << " | " << n * 1000.0 / elapsedMs << " fps"
+         << std::setprecision(3) << " | p50 " << window.percentile(50) << " ms, p99 " << window.percentile(99)
+         << " ms, max " << window.maxMs() << " ms" << endl;
+    cout.unsetf(std::ios::floatfield);
+    cout << std::setprecision(6);
+}
@@ -0,0 +1,246 @@
+#include "../include/StreamServer.h"
+#include "../include/HogDetector.h"
+#include "../include/LatencyRecorder.h"
+#include "../include/Utils.h"
+#include <omp.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace cv;
+using namespace std;
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+// ==========================================
+// CONFIGURATION
+// ==========================================
+// Frames processed per stream. Video files wrap around, like the single-stream benchmark.
+static constexpr int FRAMES_PER_STREAM = 2000;
+
+// Frames buffered per stream.
+// Live cameras drop their oldest frame when full, files wait for a free slot.
+static constexpr size_t QUEUE_DEPTH = 4;
+// ==========================================
+
+namespace {
+    struct PendingFrame {
+        Mat frame;
+        int id;
+        Clock::time_point captured;
+    };
+
+    struct Stream {
+        string source;
+        bool live = false;
+        deque<PendingFrame> queue;
+        int dropped = 0;
+
+        // End-to-end latency per frame (capture -> histograms ready, queueing included).
+        // Workers record under Shared::lock, which keeps the recorder single-producer.
+        unique_ptr<LatencyRecorder> latency;
+        double computeMsTotal = 0.0;
+        Clock::time_point firstCapture, lastDone;
+    };
+
+    // Everything below is guarded by 'lock'. One mutex is plenty for a few dozen streams:
+    // it is held only to move a Mat header in or out of a queue.
+    struct Shared {
+        mutex lock;
+        condition_variable frameReady;  // Workers wait here
+        condition_variable spaceFree;   // File readers wait here
+        vector<unique_ptr<Stream>> streams;
+        size_t cursor = 0;              // Round-robin position
+        int activeReaders = 0;
+    };
+
+    double toMs(Clock::duration d) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(d).count() / 1000.0;
+    }
+
+    bool isCameraIndex(const string& source) {
+        return source.size() == 1 && isdigit(source[0]);
+    }
+
+    // Fair scheduling: continue scanning after the last stream served,
+    // so a fast source can never starve the others.
+    Stream* pickStream(Shared& sh) {
+        size_t n = sh.streams.size();
+        for (size_t i = 1; i <= n; i++) {
+            size_t idx = (sh.cursor + i) % n;
+            if (!sh.streams[idx]->queue.empty()) {
+                sh.cursor = idx;
+                return sh.streams[idx].get();
+            }
+        }
+        return nullptr;
+    }
+
+    void readerLoop(Shared& sh, Stream& st) {
+        VideoCapture cap;
+        Mat still;
+
+        string ext = fs::path(st.source).extension().string();
+        if (st.live || ext == ".mp4" || ext == ".avi" || ext == ".mov") cap = Utils::openVideo(st.source);
+        else still = imread(st.source);
+
+        bool ok = cap.isOpened() || !still.empty();
+        if (!ok) cerr << "[Error] Cannot read stream source: " << st.source << endl;
+
+        int produced = 0;
+        bool rewound = false;
+        while (ok && produced < FRAMES_PER_STREAM) {
+            Mat frame;
+            if (!still.empty()) {
+                frame = still; // Shared header: detectors only read their input
+            } else {
+                cap >> frame;
+                if (frame.empty()) {
+                    // Camera gone, or a file that is empty even after rewinding
+                    if (st.live || rewound) break;
+                    cap.set(cv::CAP_PROP_POS_FRAMES, 0);
+                    rewound = true;
+                    continue;
+                }
+                rewound = false;
+            }
+
+            unique_lock<mutex> lk(sh.lock);
+            if (st.live) {
+                if (st.queue.size() >= QUEUE_DEPTH) {
+                    st.queue.pop_front();
+                    st.dropped++;
+                }
+            } else {
+                sh.spaceFree.wait(lk, [&] { return st.queue.size() < QUEUE_DEPTH; });
+            }
+            Clock::time_point now = Clock::now();
+            if (produced == 0) st.firstCapture = now;
+            st.queue.push_back({frame, produced++, now});
+            lk.unlock();
+            sh.frameReady.notify_one();
+        }
+
+        {
+            lock_guard<mutex> lk(sh.lock);
+            sh.activeReaders--;
+        }
+        sh.frameReady.notify_all();
+    }
+
+    void workerLoop(Shared& sh, HogDetector* detector, int ompThreads) {
+        // The pool is the parallelism. Cap the OpenMP team of this worker
+        // so N workers do not spawn N full-size teams.
+        omp_set_num_threads(ompThreads);
+
+        while (true) {
+            unique_lock<mutex> lk(sh.lock);
+            Stream* st = nullptr;
+            sh.frameReady.wait(lk, [&] {
+                st = pickStream(sh);
+                return st != nullptr || sh.activeReaders == 0;
+            });
+            if (!st) break; // Readers finished and every queue is drained
+
+            PendingFrame job = std::move(st->queue.front());
+            st->queue.pop_front();
+            lk.unlock();
+            sh.spaceFree.notify_all();
+
+            auto start = Clock::now();
+            detector->computeHOG(job.frame, false);
+            auto end = Clock::now();
+
+            lk.lock();
+            BenchmarkStats s;
+            s.frameId = job.id;
+            s.width = job.frame.cols;
+            s.height = job.frame.rows;
+            s.timeMs = toMs(end - job.captured);
+            st->latency->record(s);
+            st->computeMsTotal += toMs(end - start);
+            st->lastDone = end;
+        }
+    }
+}
+
+StreamServer::StreamServer(DetectorFactory factory, int workerCount)
+    : factory(std::move(factory)), workerCount(workerCount) {}
+
+void StreamServer::run(const vector<string>& sources) {
+    if (sources.empty()) {
+        cerr << "[Error] Multi-stream mode needs at least one source." << endl;
+        return;
+    }
+
+    int cores = max(1, (int)thread::hardware_concurrency());
+    int workers = (workerCount > 0) ? workerCount : cores;
+    int ompThreads = max(1, cores / workers);
+
+    cout << "\n=== Running Multi-Stream Server: " << sources.size() << " streams, "
+         << workers << " workers ===" << endl;
+
+    vector<unique_ptr<HogDetector>> detectors;
+    for (int i = 0; i < workers; i++) {
+        HogDetector* d = factory();
+        if (!d) {
+            cerr << "[Error] Could not create a detector for the worker pool." << endl;
+            return;
+        }
+        detectors.emplace_back(d);
+    }
+
+    Shared sh;
+    for (const auto& source : sources) {
+        auto st = make_unique<Stream>();
+        st->source = source;
+        st->live = isCameraIndex(source);
+        // Rolling lines from every stream would interleave; the report below summarizes each
+        st->latency = make_unique<LatencyRecorder>("Stream " + to_string(sh.streams.size()),
+                                                   "Stream_" + to_string(sh.streams.size()) + ".csv", 0.0);
+        sh.streams.push_back(std::move(st));
+    }
+    sh.activeReaders = (int)sources.size();
+
+    auto runStart = Clock::now();
+
+    vector<thread> threads;
+    for (auto& st : sh.streams) threads.emplace_back(readerLoop, std::ref(sh), std::ref(*st));
+    for (auto& d : detectors) threads.emplace_back(workerLoop, std::ref(sh), d.get(), ompThreads);
+    for (auto& t : threads) t.join();
+
+    double wallMs = toMs(Clock::now() - runStart);
+
+    // --- Report ---
+    long long totalFrames = 0;
+    for (size_t i = 0; i < sh.streams.size(); i++) {
+        Stream& st = *sh.streams[i];
+        st.latency->finish();
+        const LatencyHistogram& latency = st.latency->overall();
+        size_t n = latency.count();
+        totalFrames += n;
+        if (n == 0) {
+            cout << "[Stream " << i << "] " << st.source << ": no frames processed" << endl;
+            continue;
+        }
+
+        double spanMs = toMs(st.lastDone - st.firstCapture);
+        double fps = spanMs > 0.0 ? n * 1000.0 / spanMs : 0.0;
+
+        cout << "[Stream " << i << "] " << st.source << ": " << n << " frames"
+             << " (" << st.dropped << " dropped)"
+             << " | latency avg " << latency.meanMs() << " ms, p99 " << latency.percentile(99) << " ms"
+             << " | compute avg " << st.computeMsTotal / n << " ms"
+             << " | " << fps << " fps" << endl;
+    }
+
+    double aggregateFps = wallMs > 0.0 ? totalFrames * 1000.0 / wallMs : 0.0;
+    cout << "[Aggregate] " << totalFrames << " frames in " << wallMs / 1000.0 << " s = "
+         << aggregateFps << " fps across " << sh.streams.size() << " streams" << endl;
+}
@@ -0,0 +1,96 @@
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+using namespace std;
+
+// Chunks per thread: enough to balance uneven rows, few enough to keep overhead low.
+static constexpr int CHUNKS_PER_THREAD = 4;
+
+static thread_local bool isPoolWorker = false;
+
+ThreadPool::ThreadPool(int threadCount) {
+    if (threadCount <= 0) threadCount = max(1, (int)thread::hardware_concurrency() - 1);
+    for (int i = 0; i < threadCount; i++) workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lk(lock);
+        stopping = true;
+    }
+    taskReady.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+void ThreadPool::submit(function<void()> task) {
+    {
+        lock_guard<mutex> lk(lock);
+        tasks.push_back(std::move(task));
+    }
+    taskReady.notify_one();
+}
+
+bool ThreadPool::inWorker() {
+    return isPoolWorker;
+}
+
+void ThreadPool::workerLoop() {
+    isPoolWorker = true;
+    while (true) {
+        function<void()> task;
+        {
+            unique_lock<mutex> lk(lock);
+            taskReady.wait(lk, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return; // Stopping and drained
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(int begin, int end, const function<void(int)>& body) {
+    int n = end - begin;
+    if (n <= 0) return;
+
+    int chunkCount = min(n, (size() + 1) * CHUNKS_PER_THREAD);
+    int chunkSize = (n + chunkCount - 1) / chunkCount;
+    chunkCount = (n + chunkSize - 1) / chunkSize;
+
+    struct Job {
+        atomic<int> next{0};
+        atomic<int> done{0};
+        mutex m;
+        condition_variable finished;
+    };
+    auto job = make_shared<Job>();
+
+    // Helpers that start after every chunk is claimed return without touching 'body',
+    // so it is safe for them to outlive this call.
+    auto runChunks = [job, begin, end, chunkSize, chunkCount, &body]() {
+        int c;
+        while ((c = job->next++) < chunkCount) {
+            int from = begin + c * chunkSize;
+            int to = min(end, from + chunkSize);
+            for (int i = from; i < to; i++) body(i);
+            if (++job->done == chunkCount) {
+                lock_guard<mutex> lk(job->m);
+                job->finished.notify_all();
+            }
+        }
+    };
+
+    int helpers = min(size(), chunkCount - 1);
+    for (int h = 0; h < helpers; h++) submit(runChunks);
+    runChunks();
+
+    unique_lock<mutex> lk(job->m);
+    job->finished.wait(lk, [&] { return job->done == chunkCount; });
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
@@ -1,5 +1,10 @@
 #include "../include/Utils.h"
 #include "../include/HogDetector.h" 
+#include "../include/AdaptiveQuality.h"
+#include "../include/HogCascade.h"
+#include "../include/FrameCache.h"
+#include "../include/LatencyRecorder.h"
+#include "../include/ShmRingWriter.h"
 #include <iostream>
 #include <fstream>
 #include <iomanip>
@@ -7,6 +12,7 @@
 #include <filesystem>
 #include <numeric>
 #include <chrono>
+#include <memory>
 
 using namespace cv;
 using namespace std;
@@ -33,20 +39,6 @@ VideoCapture Utils::openVideo(const string& source) {
     return cap;
 }
 
-void Utils::saveTimesToCSV(const string& filename, const vector<BenchmarkStats>& stats) {
-    string outputDir = "../results/";
-    if (!fs::exists(outputDir)) fs::create_directories(outputDir);
-
-    ofstream file(outputDir + filename);
-    if (!file.is_open()) return;
-
-    file << "Frame,Width,Height,Time_ms\n";
-    for (const auto& s : stats) {
-        file << s.frameId << "," << s.width << "," << s.height << "," << s.timeMs << "\n";
-    }
-    cout << "[Saved] Stats to " << outputDir << filename << endl;
-}
-
 void Utils::saveFrame(const Mat& resultImage, int frameId) {
     if (resultImage.empty()) return;
     
@@ -63,49 +55,167 @@ void Utils::saveFrame(const Mat& resultImage, int frameId) {
 
 // --- BENCHMARK LOGIC ---
 
-static void processFrameInternal(HogDetector* detector, Mat& img, int id, vector<BenchmarkStats>& stats) {
+// Per-run state shared by every frame of one benchmark
+struct FrameContext {
+    AdaptiveQuality* adaptive = nullptr;
+    bool timeDescriptor = false;
+    vector<float> descriptor; // Reused output of the block-normalization consumer
+
+    // Descriptor sink. Created on the first frame, sized for shmMaxFrame (or that frame's grid).
+    string shmName;
+    int shmSlots = 0;
+    Size shmMaxFrame;
+    bool shmReplace = false;
+    unique_ptr<ShmRingWriter> shm;
+    bool shmFailed = false;
+    int shmSkipped = 0; // Frames too large for the slots
+
+    HogCascade* cascade = nullptr;
+    CascadeTotals cascadeTotals;
+    unique_ptr<CsvRowLog<CascadeFrameStats>> cascadeLog; // Per-frame stage rows
+
+    CachedHogDetector* cache = nullptr;
+};
+
+static void publishToShm(FrameContext& ctx, HogDetector* detector, int id) {
+    if (ctx.shmName.empty() || ctx.shmFailed) return;
+    HistogramGrid grid = detector->getHistogramGrid();
+    if (grid.empty()) return;
+
+    if (!ctx.shm) {
+        try {
+            size_t capacity = grid.rowStride * grid.cellsY;
+            if (!ctx.shmMaxFrame.empty()) {
+                size_t maxCells = (size_t)(ctx.shmMaxFrame.width / HogDetector::CELL_WIDTH) *
+                                  (ctx.shmMaxFrame.height / HogDetector::CELL_HEIGHT);
+                capacity = std::max(capacity, maxCells * grid.cellStride);
+            }
+            ctx.shm = make_unique<ShmRingWriter>(ctx.shmName, ctx.shmSlots, (uint32_t)capacity, ctx.shmReplace);
+            cout << "[SHM] Publishing to /dev/shm/" << ctx.shmName << " (" << ctx.shmSlots
+                 << " slots x " << capacity << " floats)" << endl;
+        } catch (const exception& e) {
+            cerr << e.what() << " -- descriptor sink disabled." << endl;
+            ctx.shmFailed = true;
+            return;
+        }
+    }
+    // Slots never grow under live readers: warn once, count the rest
+    if (!ctx.shm->publish(id, grid, HogDetector::BIN_COUNT) && ctx.shmSkipped++ == 0) {
+        cerr << "[SHM] Frame " << id << " grid (" << grid.cellsX << "x" << grid.cellsY
+             << " cells) is larger than the ring slots; such frames are skipped. "
+             << "Size the ring with --shm-max <W>x<H>." << endl;
+    }
+}
+
+static void processFrameInternal(HogDetector* detector, Mat& img, int id, LatencyRecorder& recorder, FrameContext& ctx) {
     if (img.empty()) return;
+    AdaptiveQuality* adaptive = ctx.adaptive;
 
     // 1. Start Timer
     auto start = std::chrono::high_resolution_clock::now();
     
-    // 2. Run Algorithm
-    Mat visual = detector->computeHOG(img, SAVE_OUTPUT);
+    // 2. Run Algorithm (at the quality level the budget allows, if any)
+    int quality = QUALITY_FULL;
+    Size workSize = img.size();
+    Mat visual;
+    if (adaptive) {
+        quality = adaptive->currentLevel();
+        Mat work;
+        adaptive->prepareFrame(img, detector, work);
+        workSize = work.size();
+        visual = detector->computeHOG(work, SAVE_OUTPUT);
+    } else {
+        visual = detector->computeHOG(img, SAVE_OUTPUT);
+    }
+
+    // Layout benchmarks also time the consumer, which is where the layout pays off
+    if (ctx.timeDescriptor) computeBlockDescriptor(detector->getHistogramGrid(), ctx.descriptor);
     
     // 3. Stop Timer
     auto end = std::chrono::high_resolution_clock::now();
     double ms = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+    if (adaptive) adaptive->record(ms);
 
     BenchmarkStats s;
     s.frameId = id;
     s.width = img.cols;
     s.height = img.rows;
     s.timeMs = ms;
-    stats.push_back(s);
+    s.quality = quality;
+    bool cacheHit = ctx.cache && ctx.cache->lastStats().hit;
+    if (ctx.cache) {
+        s.hashMs = ctx.cache->lastStats().hashMs;
+        s.cacheHit = cacheHit ? 1 : 0;
+    }
+    recorder.record(s);
+
+    // Cascade reference: the same frame through the full-resolution pass (not timed above).
+    // Cache hits never reached the cascade.
+    if (ctx.cascade && !cacheHit) {
+        ctx.cascade->measureFullPass();
+        CascadeFrameStats cs = ctx.cascade->lastStats();
+        cs.frameId = id;
+        ctx.cascadeTotals.add(cs);
+        ctx.cascadeLog->push(cs);
+    }
 
-    // 4. Logging
-    // CLEAN CODE FIX: Use the detector's method instead of duplicating math here.
-    long long featureCount = detector->getFeatureCount(img.size());
+    // Output sink (outside the timed section, like saving frames)
+    publishToShm(ctx, detector, id);
 
-    if (SAVE_OUTPUT) {
-        cout << "ID " << id << " [" << img.cols << "x" << img.rows << "]: " 
-             << ms << " ms (" << featureCount << " features) [Saved]" << endl;
-        Utils::saveFrame(visual, id);
-    } else {
-        if (id % 100 == 0 || id == 0) {
-            cout << "ID " << id << " [" << img.cols << "x" << img.rows << "]: " 
-                 << ms << " ms (" << featureCount << " features)" << endl;
-        }
+    // 4. Logging: per-frame numbers go to the recorder; the console gets one line per second
+    if (id == 0) {
+        cout << "ID " << id << " [" << img.cols << "x" << img.rows << "]: " << ms << " ms ("
+             << detector->getFeatureCount(workSize) << " features, Q" << quality << ")" << endl;
     }
+    if (SAVE_OUTPUT) Utils::saveFrame(visual, id);
 }
 
-void Utils::runBenchmarkTask(HogDetector* detector, const string& inputPath, const string& methodName, const string& outputFileName) {
+void Utils::runBenchmarkTask(HogDetector* detector, const string& inputPath, const string& methodName, const string& outputFileName, const BenchmarkOptions& options) {
     cout << "\n=== Running Benchmark: " << methodName << " ===" << endl;
     
     if (SAVE_OUTPUT) cout << "[WARNING] SAVE_OUTPUT is ON. Performance will be lower due to I/O." << endl;
     else cout << "[INFO] SAVE_OUTPUT is OFF. Running pure algorithm speed test." << endl;
+
+    // The cascade wraps the backend; everything below drives the wrapper
+    unique_ptr<HogCascade> cascade;
+    if (options.cascadeThreshold > 0.0) {
+        cascade = make_unique<HogCascade>(detector, options.cascadeThreshold);
+        detector = cascade.get();
+        cout << "[Cascade] Window threshold: " << options.cascadeThreshold << " x best window" << endl;
+    }
+
+    // Outside the cascade and inside the adaptive controller: a hit skips all the work,
+    // and the row step the controller picks is part of the cache key
+    unique_ptr<FrameCache> frameCache;
+    unique_ptr<CachedHogDetector> cached;
+    if (options.cacheBudgetMB > 0) {
+        frameCache = make_unique<FrameCache>((size_t)options.cacheBudgetMB << 20);
+        cached = make_unique<CachedHogDetector>(detector, frameCache.get());
+        detector = cached.get();
+        cout << "[Cache] Result cache budget: " << options.cacheBudgetMB << " MB" << endl;
+    }
+
+    unique_ptr<AdaptiveQuality> adaptive;
+    if (options.latencyBudgetMs > 0.0) {
+        adaptive = make_unique<AdaptiveQuality>(options.latencyBudgetMs, detector);
+        cout << "[Adaptive] Latency budget: " << options.latencyBudgetMs << " ms per frame" << endl;
+    }
+
+    if (!detector->setHistogramLayout(options.layout)) {
+        cerr << "[Error] " << methodName << " does not support the requested histogram layout." << endl;
+        return;
+    }
+
+    FrameContext ctx;
+    ctx.adaptive = adaptive.get();
+    ctx.timeDescriptor = options.timeDescriptor;
+    ctx.shmName = options.shmName;
+    ctx.shmSlots = options.shmSlots;
+    ctx.shmMaxFrame = options.shmMaxFrame;
+    ctx.shmReplace = options.shmReplace;
+    ctx.cascade = cascade.get();
+    ctx.cache = cached.get();
     
-    vector<BenchmarkStats> stats;
     vector<string> imageFiles;
     VideoCapture cap;
     bool isVideo = false;
@@ -140,6 +250,16 @@ void Utils::runBenchmarkTask(HogDetector* detector, const string& inputPath, con
         return;
     }
 
+    // Bounded memory however long the run: histograms, running sums and background CSV writers
+    LatencyRecorder recorder(methodName, outputFileName);
+    if (adaptive) recorder.setBudgetMs(options.latencyBudgetMs);
+    if (cascade) {
+        string stagesFile = outputFileName;
+        stagesFile.insert(stagesFile.rfind('.'), "_Stages");
+        ctx.cascadeLog = make_unique<CsvRowLog<CascadeFrameStats>>(stagesFile, HogCascade::STATS_CSV_HEADER,
+                                                                   "Cascade stages", &HogCascade::writeStatsRow);
+    }
+
     if (isVideo) {
         Mat frame;
         int frameIdx = 0;
@@ -150,27 +270,62 @@ void Utils::runBenchmarkTask(HogDetector* detector, const string& inputPath, con
                 cap.set(cv::CAP_PROP_POS_FRAMES, 0);
                 continue;
             }
-            processFrameInternal(detector, frame, frameIdx++, stats);
+            processFrameInternal(detector, frame, frameIdx++, recorder, ctx);
         }
         cout << "[Done] Processed " << frameIdx << " frames (Virtual Loop)." << endl;
     } else {
         int imgIdx = 0;
         for (const auto& file : imageFiles) {
             Mat img = imread(file);
-            processFrameInternal(detector, img, imgIdx++, stats);
+            processFrameInternal(detector, img, imgIdx++, recorder, ctx);
         }
         if (imageFiles.empty() && !isVideo) {
              Mat img = imread(inputPath);
              if (!img.empty()) {
                  cout << "[Info] Looping single image for benchmark stability..." << endl;
                  for(int i=0; i < MIN_BENCHMARK_FRAMES; i++) {
-                     processFrameInternal(detector, img, i, stats);
+                     processFrameInternal(detector, img, i, recorder, ctx);
                  }
              }
         }
     }
 
-    if (!stats.empty()) {
-        Utils::saveTimesToCSV(outputFileName, stats);
+    recorder.finish();
+    const RecorderTotals& totals = recorder.totals();
+    const LatencyHistogram& latency = recorder.overall();
+
+    if (adaptive && totals.frames > 0) {
+        static_assert(QUALITY_LEVEL_COUNT <= RecorderTotals::MAX_QUALITY_LEVELS, "Recorder tracks too few quality levels");
+        cout << "[Adaptive] Frames per quality level:";
+        for (int l = 0; l < QUALITY_LEVEL_COUNT; l++) cout << " Q" << l << "=" << totals.perQuality[l];
+        cout << " | over budget: " << totals.overBudget << "/" << totals.frames << endl;
+    }
+
+    if (ctx.cascadeLog) ctx.cascadeLog->finish();
+    const CascadeTotals& ct = ctx.cascadeTotals;
+    if (cascade && ct.frames > 0) {
+        size_t n = ct.frames;
+        cout << "[Cascade] avg coarse " << ct.coarseMs / n << " ms + fine " << ct.fineMs / n << " ms vs full "
+             << ct.fullMs / n << " ms | pruned " << 100.0 * ct.prunedFraction / n << "% | speedup "
+             << (ct.coarseMs + ct.fineMs > 0.0 ? ct.fullMs / (ct.coarseMs + ct.fineMs) : 0.0) << "x" << endl;
+    }
+
+    if (cached && totals.frames > 0) {
+        // Hit frames pay hashing (+ lookup); miss frames pay hashing + compute + insert
+        uint64_t hits = totals.cacheHits;
+        uint64_t misses = totals.frames - hits;
+        double missMs = totals.totalMs - totals.cacheHitMs;
+        cout << "[Cache] hit rate " << 100.0 * hits / totals.frames << "% (" << hits << "/" << totals.frames
+             << ") | hash avg " << totals.hashMs / totals.frames << " ms | hit avg " << (hits ? totals.cacheHitMs / hits : 0.0)
+             << " ms vs miss avg " << (misses ? missMs / misses : 0.0) << " ms | " << frameCache->entryCount()
+             << " entries, " << frameCache->sizeBytes() / (1024.0 * 1024.0) << " MB, "
+             << frameCache->evictionCount() << " evictions" << endl;
+    }
+
+    if (totals.frames > 0) {
+        cout << "[Summary] " << methodName << ": avg " << latency.meanMs() << " ms/frame, "
+             << (totals.totalMs > 0.0 ? totals.frames * 1000.0 / totals.totalMs : 0.0) << " fps | p50 "
+             << latency.percentile(50) << " ms, p99 " << latency.percentile(99) << " ms, max "
+             << latency.maxMs() << " ms" << endl;
     }
 }
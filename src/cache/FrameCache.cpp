@@ -0,0 +1,213 @@
+#include "../../include/FrameCache.h"
+#include "../../include/HogVisualizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace cv;
+using namespace std;
+
+// ==========================================
+// CONFIGURATION
+// ==========================================
+// XXH64 seed of the first row; later rows of a non-continuous frame chain from the previous hash.
+static constexpr uint64_t FRAME_HASH_SEED = 0;
+// ==========================================
+
+// --- XXH64 (Yann Collet's xxHash, 64-bit variant) ---
+// Four independent 64-bit lanes per 32-byte stripe keep the multipliers busy: several GB/s,
+// a fraction of a millisecond for a Full HD frame.
+namespace {
+    constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+    constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+    inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    // Little-endian reads; memcpy compiles to a plain load and allows unaligned rows
+    inline uint64_t read64(const uint8_t* p) { uint64_t v; memcpy(&v, p, 8); return v; }
+    inline uint32_t read32(const uint8_t* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+
+    inline uint64_t xxhRound(uint64_t acc, uint64_t input) {
+        acc += input * PRIME64_2;
+        acc = rotl(acc, 31);
+        return acc * PRIME64_1;
+    }
+
+    inline uint64_t mergeRound(uint64_t acc, uint64_t val) {
+        acc ^= xxhRound(0, val);
+        return acc * PRIME64_1 + PRIME64_4;
+    }
+}
+
+uint64_t FrameCache::xxh64(const void* data, size_t length, uint64_t seed) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + length;
+    uint64_t h;
+
+    if (length >= 32) {
+        uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+        uint64_t v2 = seed + PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME64_1;
+        const uint8_t* limit = end - 32;
+        do {
+            v1 = xxhRound(v1, read64(p));
+            v2 = xxhRound(v2, read64(p + 8));
+            v3 = xxhRound(v3, read64(p + 16));
+            v4 = xxhRound(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    } else {
+        h = seed + PRIME64_5;
+    }
+    h += (uint64_t)length;
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= xxhRound(0, read64(p));
+        h = rotl(h, 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (p + 4 <= end) {
+        h ^= (uint64_t)read32(p) * PRIME64_1;
+        h = rotl(h, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= (*p) * PRIME64_5;
+        h = rotl(h, 11) * PRIME64_1;
+    }
+
+    // Avalanche
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t FrameCache::hashFrame(const Mat& img) {
+    if (img.empty()) return 0;
+    size_t rowBytes = (size_t)img.cols * img.elemSize();
+    if (img.isContinuous()) return xxh64(img.data, rowBytes * img.rows, FRAME_HASH_SEED);
+
+    // ROIs / padded rows: only the pixels count, never the gap between rows
+    uint64_t h = FRAME_HASH_SEED;
+    for (int y = 0; y < img.rows; y++) h = xxh64(img.ptr(y), rowBytes, h);
+    return h;
+}
+
+// --- LRU ---
+
+FrameCache::FrameCache(size_t budgetBytes) : budget(budgetBytes) {}
+
+shared_ptr<const CachedGrid> FrameCache::find(const FrameKey& key) {
+    lock_guard<mutex> lk(lock);
+    auto it = index.find(key);
+    if (it == index.end()) return nullptr;
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->second;
+}
+
+void FrameCache::insert(const FrameKey& key, const HistogramGrid& grid) {
+    if (grid.empty()) return;
+
+    // Copy outside the lock: from the first cell to the end of the last one, keeping the strides
+    auto entry = make_shared<CachedGrid>();
+    entry->cellsX = grid.cellsX;
+    entry->cellsY = grid.cellsY;
+    entry->cellStride = grid.cellStride;
+    entry->rowStride = grid.rowStride;
+    size_t floats = (size_t)(grid.cellsY - 1) * grid.rowStride + (size_t)grid.cellsX * grid.cellStride;
+    entry->data.assign(grid.data, grid.data + floats);
+
+    size_t bytes = entry->bytes();
+    if (bytes > budget) return;
+
+    lock_guard<mutex> lk(lock);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        // Another worker stored the same frame first
+        lru.splice(lru.begin(), lru, it->second);
+        return;
+    }
+    lru.emplace_front(key, std::move(entry));
+    index[key] = lru.begin();
+    used += bytes;
+
+    while (used > budget) {
+        const Entry& victim = lru.back();
+        used -= victim.second->bytes();
+        index.erase(victim.first);
+        lru.pop_back();
+        evictions++;
+    }
+}
+
+size_t FrameCache::sizeBytes() const {
+    lock_guard<mutex> lk(lock);
+    return used;
+}
+
+size_t FrameCache::entryCount() const {
+    lock_guard<mutex> lk(lock);
+    return lru.size();
+}
+
+size_t FrameCache::evictionCount() const {
+    lock_guard<mutex> lk(lock);
+    return evictions;
+}
+
+// --- Decorator ---
+
+CachedHogDetector::CachedHogDetector(HogDetector* backend, FrameCache* cache)
+    : backend(backend), cache(cache) {}
+
+Mat CachedHogDetector::computeHOG(const Mat& input, bool visualize) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    FrameKey key;
+    key.hash = FrameCache::hashFrame(input);
+    key.width = input.cols;
+    key.height = input.rows;
+    key.type = input.type();
+    key.rowStep = rowStep;
+    key.layout = layout;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    stats.hashMs = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1000.0;
+
+    current = cache->find(key);
+    stats.hit = (current != nullptr);
+    if (stats.hit) {
+        if (!visualize) return Mat();
+        return HogVisualizer::render(current->view(), input);
+    }
+
+    Mat visual = backend->computeHOG(input, visualize);
+    cache->insert(key, backend->getHistogramGrid());
+    return visual;
+}
+
+HistogramGrid CachedHogDetector::getHistogramGrid() const {
+    return current ? current->view() : backend->getHistogramGrid();
+}
+
+bool CachedHogDetector::setHistogramLayout(HistogramLayout newLayout) {
+    if (!backend->setHistogramLayout(newLayout)) return false;
+    layout = newLayout;
+    current.reset();
+    return true;
+}
+
+void CachedHogDetector::setRowStep(int step) {
+    HogDetector::setRowStep(step);
+    backend->setRowStep(step);
+}
@@ -0,0 +1,208 @@
+#include "../../include/HogCascade.h"
+#include "../../include/Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+
+using namespace cv;
+using namespace std;
+
+// ==========================================
+// CONFIGURATION
+// ==========================================
+// Downscale of the coarse pass (one coarse cell = COARSE_SCALE x COARSE_SCALE full cells).
+static constexpr int COARSE_SCALE = 2;
+
+// Cells added around every surviving region, so its border cells get exact gradients.
+static constexpr int REGION_MARGIN_CELLS = 1;
+// ==========================================
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start,
+                        std::chrono::high_resolution_clock::time_point end) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+}
+
+HogCascade::HogCascade(HogDetector* backend, double threshold)
+    : backend(backend), threshold(std::min(1.0, std::max(0.0, threshold))) {}
+
+void HogCascade::setRowStep(int step) {
+    HogDetector::setRowStep(step);
+    backend->setRowStep(step);
+}
+
+// Resets the per-frame state. False if the frame holds no complete cell.
+bool HogCascade::beginFrame(const Mat& input) {
+    stats = CascadeFrameStats();
+    lastInput = input;
+    gridSize = Size(input.cols / CELL_WIDTH, input.rows / CELL_HEIGHT);
+    cellHistograms.assign((size_t)gridSize.width * gridSize.height * BIN_COUNT, 0.0f);
+    return gridSize.width > 0 && gridSize.height > 0;
+}
+
+Mat HogCascade::computeHOG(const Mat& input, bool visualize) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    if (!beginFrame(input)) return Mat();
+
+    // --- 1. Coarse pass ---
+    resize(input, half, Size(input.cols / COARSE_SCALE, input.rows / COARSE_SCALE), 0, 0, INTER_AREA);
+    backend->computeHOG(half, false);
+    selectCells(backend->getHistogramGrid());
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    // --- 2. Fine pass on the surviving regions ---
+    vector<Rect> regions;
+    computeRegions(input, regions);
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    stats.coarseMs = elapsedMs(t0, t1);
+    stats.fineMs = elapsedMs(t1, t2);
+
+    if (!visualize) return Mat();
+
+    // Surviving regions over the input frame
+    Mat vis;
+    if (input.channels() == 1) cvtColor(input, vis, COLOR_GRAY2BGR);
+    else vis = input.clone();
+    for (const Rect& r : regions) {
+        rectangle(vis, Rect(r.x * CELL_WIDTH, r.y * CELL_HEIGHT, r.width * CELL_WIDTH, r.height * CELL_HEIGHT),
+                  Scalar(0, 255, 0), 2);
+    }
+    return vis;
+}
+
+void HogCascade::computeMasked(const Mat& input, const Mat& mask) {
+    if (!beginFrame(input)) return;
+    CV_Assert(mask.type() == CV_8U && mask.size() == gridSize);
+    mask.copyTo(cellMask);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    vector<Rect> regions;
+    computeRegions(input, regions);
+    stats.fineMs = elapsedMs(t0, std::chrono::high_resolution_clock::now());
+}
+
+// Scores every window on the coarse grid and marks the full-resolution cells of the survivors.
+void HogCascade::selectCells(const HistogramGrid& coarse) {
+    int cw = coarse.cellsX;
+    int ch = coarse.cellsY;
+    // Window in coarse cells. Frames smaller than a window are one window.
+    int winX = std::min(cw, Utils::WIN_WIDTH / (CELL_WIDTH * COARSE_SCALE));
+    int winY = std::min(ch, Utils::WIN_HEIGHT / (CELL_HEIGHT * COARSE_SCALE));
+
+    cellMask = Mat::zeros(gridSize, CV_8U);
+    if (cw == 0 || ch == 0) return;
+
+    // Integral image of per-cell gradient energy (sum of the cell's bins)
+    size_t stride = cw + 1;
+    energy.assign(stride * (ch + 1), 0.0);
+    for (int cy = 0; cy < ch; cy++) {
+        double rowSum = 0.0;
+        for (int cx = 0; cx < cw; cx++) {
+            const float* cell = coarse.cell(cx, cy);
+            for (int b = 0; b < BIN_COUNT; b++) rowSum += cell[b];
+            energy[(cy + 1) * stride + cx + 1] = energy[cy * stride + cx + 1] + rowSum;
+        }
+    }
+    auto windowScore = [&](int wx, int wy) {
+        return energy[(wy + winY) * stride + wx + winX] - energy[wy * stride + wx + winX]
+             - energy[(wy + winY) * stride + wx] + energy[wy * stride + wx];
+    };
+
+    int windowsX = cw - winX + 1;
+    int windowsY = ch - winY + 1;
+    double best = 0.0;
+    for (int wy = 0; wy < windowsY; wy++)
+        for (int wx = 0; wx < windowsX; wx++) best = std::max(best, windowScore(wx, wy));
+
+    stats.windowsTotal = windowsX * windowsY;
+    if (best <= 0.0) return; // Flat frame: nothing to look at
+
+    // Survivors are added to a 2D difference array, then summed into per-cell coverage
+    double cut = threshold * best;
+    coverage.assign(stride * (ch + 1), 0);
+    for (int wy = 0; wy < windowsY; wy++) {
+        for (int wx = 0; wx < windowsX; wx++) {
+            if (windowScore(wx, wy) < cut) continue;
+            stats.windowsKept++;
+            coverage[wy * stride + wx]++;
+            coverage[wy * stride + wx + winX]--;
+            coverage[(wy + winY) * stride + wx]--;
+            coverage[(wy + winY) * stride + wx + winX]++;
+        }
+    }
+    for (int cy = 0; cy <= ch; cy++)
+        for (int cx = 1; cx <= cw; cx++) coverage[cy * stride + cx] += coverage[cy * stride + cx - 1];
+    for (int cy = 1; cy <= ch; cy++)
+        for (int cx = 0; cx <= cw; cx++) coverage[cy * stride + cx] += coverage[(cy - 1) * stride + cx];
+
+    // Odd full-resolution edges map onto the last coarse cell
+    for (int y = 0; y < gridSize.height; y++) {
+        const int* row = &coverage[std::min(y / COARSE_SCALE, ch - 1) * stride];
+        uchar* mask = cellMask.ptr<uchar>(y);
+        for (int x = 0; x < gridSize.width; x++) {
+            mask[x] = row[std::min(x / COARSE_SCALE, cw - 1)] > 0 ? 1 : 0;
+        }
+    }
+}
+
+// One backend call per connected region of surviving cells; only the cells
+// of surviving windows are copied out (the margin only feeds their gradients).
+// Bounding boxes of L-shaped regions can overlap, so a region copies only its own
+// cells: a neighbour's cell on the edge of this ROI has no pixels around it here.
+void HogCascade::computeRegions(const Mat& input, vector<Rect>& regions) {
+    int k = 2 * REGION_MARGIN_CELLS + 1;
+    dilate(cellMask, regionMask, getStructuringElement(MORPH_RECT, Size(k, k)));
+    int labelCount = connectedComponentsWithStats(regionMask, labels, regionStats, centroids, 8);
+
+    long long computedCells = 0;
+    for (int l = 1; l < labelCount; l++) { // Label 0 is the background
+        Rect r(regionStats.at<int>(l, CC_STAT_LEFT), regionStats.at<int>(l, CC_STAT_TOP),
+               regionStats.at<int>(l, CC_STAT_WIDTH), regionStats.at<int>(l, CC_STAT_HEIGHT));
+        regions.push_back(r);
+        computedCells += (long long)r.width * r.height;
+
+        Rect pixels(r.x * CELL_WIDTH, r.y * CELL_HEIGHT, r.width * CELL_WIDTH, r.height * CELL_HEIGHT);
+        backend->computeHOG(input(pixels), false);
+        HistogramGrid g = backend->getHistogramGrid();
+
+        int w = std::min(r.width, g.cellsX);
+        int h = std::min(r.height, g.cellsY);
+        for (int dy = 0; dy < h; dy++) {
+            const uchar* mask = cellMask.ptr<uchar>(r.y + dy);
+            const int* owner = labels.ptr<int>(r.y + dy);
+            for (int dx = 0; dx < w; dx++) {
+                if (!mask[r.x + dx] || owner[r.x + dx] != l) continue;
+                const float* src = g.cell(dx, dy);
+                float* dst = &cellHistograms[((size_t)(r.y + dy) * gridSize.width + r.x + dx) * BIN_COUNT];
+                std::copy(src, src + BIN_COUNT, dst);
+            }
+        }
+    }
+
+    // Overlapping bounding boxes count twice, hence the clamp
+    double totalCells = (double)gridSize.width * gridSize.height;
+    stats.prunedFraction = 1.0 - std::min(1.0, computedCells / totalCells);
+    stats.regions = (int)regions.size();
+}
+
+void HogCascade::measureFullPass() {
+    if (lastInput.empty()) return;
+    auto start = std::chrono::high_resolution_clock::now();
+    backend->computeHOG(lastInput, false);
+    auto end = std::chrono::high_resolution_clock::now();
+    stats.fullMs = elapsedMs(start, end);
+    lastInput.release();
+}
+
+HistogramGrid HogCascade::getHistogramGrid() const {
+    return HistogramGrid::cellMajor(cellHistograms.data(), gridSize.width, gridSize.height, BIN_COUNT);
+}
+
+const char* const HogCascade::STATS_CSV_HEADER =
+    "Frame,Coarse_ms,Fine_ms,Cascade_ms,Full_ms,Speedup,Pruned,WindowsKept,WindowsTotal,Regions";
+
+void HogCascade::writeStatsRow(ostream& out, const CascadeFrameStats& s) {
+    out << s.frameId << "," << s.coarseMs << "," << s.fineMs << "," << s.coarseMs + s.fineMs << ","
+        << s.fullMs << "," << s.speedup() << "," << s.prunedFraction << ","
+        << s.windowsKept << "," << s.windowsTotal << "," << s.regions << "\n";
+}
@@ -0,0 +1,214 @@
+#include "../../include/HogCPU.h"
+#include "../../include/ExecutionPolicies.h"
+#include "../../include/HogVisualizer.h"
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+using namespace cv;
+using namespace std;
+
+// --- Clean Code: Tuning Constants ---
+static constexpr float MAG_THRESHOLD = 0.1f;
+static constexpr float ANGLE_SCALE = 180.0f;
+
+template <class Policy>
+HogCPU<Policy>::HogCPU() : HogDetector() {
+    // Use ANGLE_SCALE here
+    binScale = static_cast<float>(BIN_COUNT) / ANGLE_SCALE;
+}
+
+template <class Policy>
+HogCPU<Policy>::~HogCPU() {
+    waitForPending();
+}
+
+template <class Policy>
+void HogCPU<Policy>::computeGradients(const Mat& img, Mat& mag, Mat& ang) {
+    // The loop below never writes the border rows/columns, but computeCells reads them:
+    // zero the buffers whenever they are (re)allocated, so border cells are deterministic.
+    if (mag.size() != img.size() || ang.size() != img.size()) {
+        mag.create(img.size(), CV_32F);
+        ang.create(img.size(), CV_32F);
+        mag.setTo(0);
+        ang.setTo(0);
+    }
+    
+    int rows = img.rows;
+    int cols = img.cols;
+    int cn = img.channels();
+
+    // Rows are multiples of rowStep (the same rows computeCells reads): y = (i + 1) * rowStep
+    int step = rowStep;
+    Policy::forRange(0, (rows - 2) / step, [&](int i) {
+        int y = (i + 1) * step;
+        const uchar* ptr = img.ptr<uchar>(y);
+        const uchar* ptrPrev = img.ptr<uchar>(y - 1);
+        const uchar* ptrNext = img.ptr<uchar>(y + 1);
+        float* magPtr = mag.ptr<float>(y);
+        float* angPtr = ang.ptr<float>(y);
+
+        for (int x = 1; x < cols - 1; x++) {
+            float maxGradSq = -1.0f;
+            float bestAngle = 0.0f;
+
+            if (cn == 1) {
+                float dx = static_cast<float>(ptr[x + 1]) - static_cast<float>(ptr[x - 1]);
+                float dy = static_cast<float>(ptrNext[x]) - static_cast<float>(ptrPrev[x]);
+                maxGradSq = dx*dx + dy*dy;
+                bestAngle = fastAtan2(dy, dx);
+            } 
+            else {
+                for (int c = 0; c < 3; c++) {
+                    float dx = static_cast<float>(ptr[(x + 1) * 3 + c]) - static_cast<float>(ptr[(x - 1) * 3 + c]);
+                    float dy = static_cast<float>(ptrNext[x * 3 + c]) - static_cast<float>(ptrPrev[x * 3 + c]);
+                    float gradSq = dx*dx + dy*dy;
+                    
+                    if (gradSq > maxGradSq) {
+                        maxGradSq = gradSq;
+                        bestAngle = fastAtan2(dy, dx); 
+                    }
+                }
+            }
+            magPtr[x] = std::sqrt(maxGradSq);
+            angPtr[x] = bestAngle;
+        }
+    });
+}
+
+template <class Policy>
+void HogCPU<Policy>::computeCells(const Mat& mag, const Mat& ang, AlignedFloatVector& cellHistograms, Size& gridSize) {
+    int cellsX = mag.cols / CELL_WIDTH;
+    int cellsY = mag.rows / CELL_HEIGHT;
+    gridSize = Size(cellsX, cellsY);
+
+    // Padded rows are cellsX * 16 floats, a multiple of 64 bytes, so every
+    // row (and every cell) of the aligned buffer starts on a cache line.
+    int cellStride = (layout == HistogramLayout::Padded16) ? PADDED_CELL_STRIDE : BIN_COUNT;
+    size_t rowStride = (size_t)cellsX * cellStride;
+
+    // Zero fill also keeps the padding lanes at 0 for the consumers
+    cellHistograms.assign(rowStride * cellsY, 0.0f);
+
+    if (layout == HistogramLayout::Padded16) accumulateCells<PADDED_CELL_STRIDE>(mag, ang, cellHistograms.data(), rowStride, gridSize);
+    else accumulateCells<BIN_COUNT>(mag, ang, cellHistograms.data(), rowStride, gridSize);
+}
+
+// Producer loop, specialized on the cell stride so the cell offset is a compile-time shift/multiply
+template <class Policy>
+template <int CellStride>
+void HogCPU<Policy>::accumulateCells(const Mat& mag, const Mat& ang, float* hist, size_t rowStride, const Size& gridSize) {
+    int cellsX = gridSize.width;
+    int cellsY = gridSize.height;
+    int step = rowStep;
+    float rowWeight = static_cast<float>(step);
+
+    Policy::forRange(0, cellsY, [&](int cy) {
+        int startY = cy * CELL_HEIGHT;
+        int endY = std::min(startY + CELL_HEIGHT, mag.rows);
+        float* rowHist = hist + cy * rowStride;
+
+        for (int y = startY; y < endY; y += step) {
+            const float* magPtr = mag.ptr<float>(y);
+            const float* angPtr = ang.ptr<float>(y);
+            int validWidth = cellsX * CELL_WIDTH;
+
+            for (int x = 0; x < validWidth; x++) {
+                float m = magPtr[x];
+                // Use Constant
+                if (m < MAG_THRESHOLD) continue;
+                m *= rowWeight;
+
+                float a = angPtr[x];
+                
+                // --- FIXED: Use ANGLE_SCALE ---
+                if (a >= ANGLE_SCALE) a -= ANGLE_SCALE;
+                if (a < 0.0f) a += ANGLE_SCALE;
+
+                float exactBin = a * binScale;
+                int b0 = static_cast<int>(exactBin);
+                
+                if (b0 >= BIN_COUNT) b0 = 0;
+                int b1 = b0 + 1;
+                if (b1 >= BIN_COUNT) b1 = 0;
+
+                float w1 = exactBin - b0;
+                float w0 = 1.0f - w1;
+
+                int cx = x / CELL_WIDTH;
+                float* cellHist = rowHist + cx * CellStride;
+                
+                cellHist[b0] += m * w0;
+                cellHist[b1] += m * w1;
+            }
+        }
+    });
+}
+
+template <class Policy>
+Mat HogCPU<Policy>::computeHOG(const Mat& input, bool visualize) {
+    computeGradients(input, mag, ang);
+    computeCells(mag, ang, cellHistograms, gridSize);
+    if (visualize) return HogVisualizer::render(getHistogramGrid(), input);
+    return Mat(); 
+}
+
+template <class Policy>
+future<HogResult> HogCPU<Policy>::computeHOGAsync(const Mat& input, bool visualize, HogCallback onComplete) {
+    auto promise = make_shared<std::promise<HogResult>>();
+    future<HogResult> result = promise->get_future();
+
+    // Settings are captured at submit time
+    int step = rowStep;
+    HistogramLayout frameLayout = layout;
+
+    asyncStarted();
+    ThreadPool::global().submit([this, input, visualize, onComplete, promise, step, frameLayout]() {
+        unique_ptr<HogCPU<SequentialPolicy>> worker;
+        {
+            lock_guard<mutex> lk(scratchLock);
+            if (!scratchFree.empty()) {
+                worker = std::move(scratchFree.back());
+                scratchFree.pop_back();
+            }
+        }
+        if (!worker) worker = make_unique<HogCPU<SequentialPolicy>>();
+        worker->setRowStep(step);
+        worker->setHistogramLayout(frameLayout);
+
+        try {
+            HogResult r;
+            r.visual = worker->computeHOG(input, visualize);
+            copyToResult(worker->getHistogramGrid(), r);
+            if (onComplete) onComplete(r);
+            promise->set_value(std::move(r));
+        } catch (...) {
+            promise->set_exception(current_exception());
+        }
+
+        {
+            lock_guard<mutex> lk(scratchLock);
+            scratchFree.push_back(std::move(worker));
+        }
+        asyncFinished();
+    });
+    return result;
+}
+
+template <class Policy>
+HistogramGrid HogCPU<Policy>::getHistogramGrid() const {
+    int cellStride = (layout == HistogramLayout::Padded16) ? PADDED_CELL_STRIDE : BIN_COUNT;
+    return { cellHistograms.data(), gridSize.width, gridSize.height, cellStride, (size_t)gridSize.width * cellStride };
+}
+
+template <class Policy>
+bool HogCPU<Policy>::setHistogramLayout(HistogramLayout newLayout) {
+    layout = newLayout;
+    return true;
+}
+
+// --- Explicit Instantiations (one per CPU backend) ---
+template class HogCPU<SequentialPolicy>;
+template class HogCPU<OpenMPPolicy>;
+template class HogCPU<StdParPolicy>;
+template class HogCPU<TaskPolicy>;
@@ -1,6 +1,8 @@
 #include "../../include/HogCUDA.h"
+#include "../../include/HogVisualizer.h"
 #include <cuda_runtime.h>
 #include <device_launch_parameters.h>
+#include <algorithm>
 #include <iostream>
 
 // --- HELPER MACROS ---
@@ -18,6 +20,13 @@
 #define PI_F 3.14159265359f
 #define RAD_TO_DEG (180.0f / PI_F)
 
+// ==========================================
+// CONFIGURATION
+// ==========================================
+// Pinned download buffers; computeHOGAsync() blocks once this many frames are in flight.
+static constexpr int ASYNC_PINNED_BUFFERS = 4;
+// ==========================================
+
 // --- DEVICE HELPERS ---
 
 // Force Read-Only Cache load (__ldg) for higher bandwidth on scattered reads
@@ -79,7 +88,8 @@ __global__ void compute_hog_kernel(
     float* __restrict__ hist, 
     int rows, 
     int cols, 
-    int step
+    int step,
+    int rowStep // Adaptive quality: visit every rowStep-th row
 ) {
     // Access constants directly from class (Clean Code)
     // Note: This requires the compiler to see the constexpr definition
@@ -102,9 +112,11 @@ __global__ void compute_hog_kernel(
     int startY = cy * CH;
     int startX = cx * CW;
 
+    float rowWeight = (float)rowStep;
+
     // Loop over pixels in the cell
     // Note: We skip the outer 1-pixel border of the IMAGE to avoid boundary checks inside
-    for (int dy = 0; dy < CH; dy++) {
+    for (int dy = 0; dy < CH; dy += rowStep) {
         int y = startY + dy;
         // Global boundary check (Image level)
         if (y < 1 || y >= rows - 1) continue;
@@ -117,6 +129,7 @@ __global__ void compute_hog_kernel(
             get_pixel_gradient(img, x, y, step, mag, angle);
 
             if (mag < 0.1f) continue; // Threshold
+            mag *= rowWeight;
 
             // Linear Interpolation for Binning
             float exactBin = angle * (BINS / 180.0f);
@@ -167,26 +180,44 @@ HogCUDA::HogCUDA() : HogDetector() {
 }
 
 HogCUDA::~HogCUDA() {
+    waitForPending();
     cleanup();
+    if (stream) cudaStreamDestroy(stream);
+}
+
+bool HogCUDA::isAvailable() {
+    int count = 0;
+    return cudaGetDeviceCount(&count) == cudaSuccess && count > 0;
 }
 
 void HogCUDA::allocateBuffers(int width, int height) {
     if (width == currentWidth && height == currentHeight) return;
-    cleanup();
+    if (!stream) CUDA_CHECK(cudaStreamCreate(&stream));
 
-    currentWidth = width;
-    currentHeight = height;
-
-    size_t imgBytes = width * height * 3 * sizeof(unsigned char);
+    size_t imgBytes = (size_t)width * height * 3 * sizeof(unsigned char);
     
     int cellsX = width / CELL_WIDTH;
     int cellsY = height / CELL_HEIGHT;
-    size_t histBytes = cellsX * cellsY * BIN_COUNT * sizeof(float);
+    size_t histFloats = (size_t)cellsX * cellsY * BIN_COUNT;
 
-    CUDA_CHECK(cudaMalloc(&d_img, imgBytes));
-    CUDA_CHECK(cudaMalloc(&d_hist, histBytes));
-    
-    cellHistograms.resize(cellsX * cellsY * BIN_COUNT);
+    currentWidth = width;
+    currentHeight = height;
+    cellHistograms.resize(histFloats);
+
+    // Buffers only grow: alternating sizes (e.g. cascade regions) reuse them
+    if (imgBytes <= imgCapacity && histFloats <= histCapacity) return;
+
+    size_t newImgCapacity = std::max(imgBytes, imgCapacity);
+    size_t newHistCapacity = std::max(histFloats, histCapacity);
+
+    // Queued frames (and their host callbacks) still use the old buffers
+    CUDA_CHECK(cudaStreamSynchronize(stream));
+    cleanup();
+
+    imgCapacity = newImgCapacity;
+    histCapacity = newHistCapacity;
+    CUDA_CHECK(cudaMalloc(&d_img, imgCapacity));
+    CUDA_CHECK(cudaMalloc(&d_hist, histCapacity * sizeof(float)));
 }
 
 void HogCUDA::cleanup() {
@@ -194,6 +225,34 @@ void HogCUDA::cleanup() {
     if (d_hist) cudaFree(d_hist);
     d_img = nullptr;
     d_hist = nullptr;
+    imgCapacity = 0;
+    histCapacity = 0;
+
+    // Only called with an idle stream, so every pinned buffer is back in the pool
+    std::lock_guard<std::mutex> lk(pinnedLock);
+    for (float* buf : pinnedFree) cudaFreeHost(buf);
+    pinnedFree.clear();
+    pinnedCount = 0;
+}
+
+float* HogCUDA::acquirePinned() {
+    std::unique_lock<std::mutex> lk(pinnedLock);
+    if (pinnedFree.empty() && pinnedCount < ASYNC_PINNED_BUFFERS) {
+        float* buf = nullptr;
+        CUDA_CHECK(cudaMallocHost(&buf, histCapacity * sizeof(float)));
+        pinnedCount++;
+        return buf;
+    }
+    pinnedReturned.wait(lk, [this] { return !pinnedFree.empty(); });
+    float* buf = pinnedFree.back();
+    pinnedFree.pop_back();
+    return buf;
+}
+
+void HogCUDA::releasePinned(float* buffer) {
+    std::lock_guard<std::mutex> lk(pinnedLock);
+    pinnedFree.push_back(buffer);
+    pinnedReturned.notify_one();
 }
 
 cv::Mat HogCUDA::computeHOG(const cv::Mat& input, bool visualize) {
@@ -206,27 +265,125 @@ cv::Mat HogCUDA::computeHOG(const cv::Mat& input, bool visualize) {
 
     // 1. Async Upload
     CUDA_CHECK(cudaMemcpyAsync(d_img, img.data, img.total() * img.elemSize(), 
-                               cudaMemcpyHostToDevice));
+                               cudaMemcpyHostToDevice, stream));
 
     // 2. Launch
     dim3 block, grid;
     getLaunchConfig(img.cols, img.rows, grid, block);
 
-    compute_hog_kernel<<<grid, block>>>(
+    compute_hog_kernel<<<grid, block, 0, stream>>>(
         d_img, 
         d_hist, 
         img.rows, 
         img.cols, 
-        (int)img.step
+        (int)img.step,
+        rowStep
     );
 
     CUDA_CHECK(cudaGetLastError());
 
-    // 3. Blocking Download (Synchronizes implicitly)
-    CUDA_CHECK(cudaMemcpy(cellHistograms.data(), d_hist, 
-                          cellHistograms.size() * sizeof(float), 
-                          cudaMemcpyDeviceToHost));
+    // 3. Download and wait (earlier async frames on the stream finish first)
+    CUDA_CHECK(cudaMemcpyAsync(cellHistograms.data(), d_hist, 
+                               cellHistograms.size() * sizeof(float), 
+                               cudaMemcpyDeviceToHost, stream));
+    CUDA_CHECK(cudaStreamSynchronize(stream));
 
-    if (visualize) return cv::Mat::zeros(img.size(), CV_8UC3); // Placeholder
+    if (visualize) return HogVisualizer::render(getHistogramGrid(), img);
     return cv::Mat();
 }
+
+struct HogCUDA::AsyncRequest {
+    HogCUDA* owner;
+    cv::Mat input; // Kept alive until the upload has run
+    bool visualize;
+    HogCallback onComplete;
+    std::promise<HogResult> promise;
+    float* pinned = nullptr;
+    cv::Size gridSize;
+};
+
+std::future<HogResult> HogCUDA::computeHOGAsync(const cv::Mat& input, bool visualize, HogCallback onComplete) {
+    AsyncRequest* req = new AsyncRequest();
+    req->owner = this;
+    req->input = input.isContinuous() ? input : input.clone();
+    req->visualize = visualize;
+    req->onComplete = std::move(onComplete);
+    std::future<HogResult> result = req->promise.get_future();
+
+    const cv::Mat& img = req->input;
+    req->gridSize = cv::Size(img.cols / CELL_WIDTH, img.rows / CELL_HEIGHT);
+
+    try {
+        allocateBuffers(img.cols, img.rows);
+        req->pinned = acquirePinned();
+
+        CUDA_CHECK(cudaMemcpyAsync(d_img, img.data, img.total() * img.elemSize(), 
+                                   cudaMemcpyHostToDevice, stream));
+
+        dim3 block, grid;
+        getLaunchConfig(img.cols, img.rows, grid, block);
+        compute_hog_kernel<<<grid, block, 0, stream>>>(
+            d_img, 
+            d_hist, 
+            img.rows, 
+            img.cols, 
+            (int)img.step,
+            rowStep
+        );
+        CUDA_CHECK(cudaGetLastError());
+
+        // Pinned memory makes the download truly asynchronous
+        CUDA_CHECK(cudaMemcpyAsync(req->pinned, d_hist, cellHistograms.size() * sizeof(float), 
+                                   cudaMemcpyDeviceToHost, stream));
+    } catch (...) {
+        // Report through the future once anything already queued for this frame is done
+        // with its buffers; the pinned buffer must go back or acquirePinned() starves.
+        cudaStreamSynchronize(stream);
+        if (req->pinned) releasePinned(req->pinned);
+        req->promise.set_exception(std::current_exception());
+        delete req;
+        return result;
+    }
+
+    asyncStarted();
+    if (cudaLaunchHostFunc(stream, onFrameDone, req) != cudaSuccess) {
+        // No host callback: complete the frame here
+        cudaGetLastError();
+        cudaStreamSynchronize(stream);
+        onFrameDone(req);
+    }
+    return result;
+}
+
+// Runs on the CUDA callback thread once the download is done: no CUDA calls allowed here.
+void HogCUDA::onFrameDone(void* userData) {
+    AsyncRequest* req = static_cast<AsyncRequest*>(userData);
+    HogCUDA* owner = req->owner;
+
+    try {
+        HogResult result;
+        result.gridSize = req->gridSize;
+        size_t count = (size_t)req->gridSize.width * req->gridSize.height * BIN_COUNT;
+        result.cellHistograms.assign(req->pinned, req->pinned + count);
+        owner->releasePinned(req->pinned);
+        req->pinned = nullptr;
+
+        if (req->visualize) {
+            HistogramGrid grid = HistogramGrid::cellMajor(result.cellHistograms.data(),
+                result.gridSize.width, result.gridSize.height, BIN_COUNT);
+            result.visual = HogVisualizer::render(grid, req->input, false); // CUDA callback thread
+        }
+        if (req->onComplete) req->onComplete(result);
+        req->promise.set_value(std::move(result));
+    } catch (...) {
+        if (req->pinned) owner->releasePinned(req->pinned);
+        req->promise.set_exception(std::current_exception());
+    }
+
+    delete req;
+    owner->asyncFinished();
+}
+
+HistogramGrid HogCUDA::getHistogramGrid() const {
+    return HistogramGrid::cellMajor(cellHistograms.data(), currentWidth / CELL_WIDTH, currentHeight / CELL_HEIGHT, BIN_COUNT);
+}
@@ -0,0 +1,439 @@
+#include "../../include/DatasetShards.h"
+#include "../../include/HogDetector.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sys/file.h>
+#include <unistd.h>
+
+using namespace cv;
+using namespace std;
+namespace fs = std::filesystem;
+
+// ==========================================
+// CONFIGURATION
+// ==========================================
+// Records are flushed one by one (enough to survive a killed process);
+// fsync every N records bounds what a machine crash can lose.
+static constexpr int FSYNC_EVERY = 256;
+
+// Progress line every N images.
+static constexpr int PROGRESS_EVERY = 1000;
+// ==========================================
+
+namespace {
+    constexpr char SHARD_MAGIC[8] = { 'H', 'O', 'G', 'S', 'H', 'R', 'D', '1' };
+
+    struct ShardFileHeader {
+        char magic[8];
+        uint32_t shardIndex;
+        uint32_t shardCount;
+        uint64_t imageCount;
+        uint64_t listHash;
+    };
+
+    // Shard record: FeatureRecordHeader, uint32 pathLength, path bytes,
+    // 'floatCount' floats, uint32 checksum of everything before it.
+    // A record only counts once its checksum is on disk.
+
+    uint32_t fnv1a32(const void* data, size_t len, uint32_t h = 2166136261u) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < len; i++) {
+            h ^= p[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    uint64_t hashList(const vector<string>& files) {
+        uint64_t h = 1469598103934665603ull;
+        for (const auto& f : files) {
+            for (unsigned char c : f) { h ^= c; h *= 1099511628211ull; }
+            h ^= '\n';
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    string shardBaseName(ShardSpec shard) {
+        return "shard_" + to_string(shard.index) + "_of_" + to_string(shard.count);
+    }
+
+    struct ShardRecord {
+        DatasetShards::FeatureRecordHeader header;
+        string path;
+        uint64_t floatOffset; // Byte offset of the floats inside the shard file
+    };
+
+    // Block descriptor length computeBlockDescriptor writes for a cellsX x cellsY grid.
+    uint64_t descriptorFloats(int32_t cellsX, int32_t cellsY) {
+        if (cellsX < 2 || cellsY < 2) return 0;
+        return (uint64_t)(cellsX - 1) * (uint64_t)(cellsY - 1) * 4 * HogDetector::BIN_COUNT;
+    }
+
+    // Reads committed records in order. Returns the byte offset just past the
+    // last valid one (everything after it is a torn write).
+    uint64_t scanShard(const string& path, const ShardFileHeader& expected, vector<ShardRecord>& records, bool& headerOk) {
+        headerOk = false;
+        ifstream in(path, ios::binary);
+        if (!in) return 0;
+
+        ShardFileHeader h;
+        if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) return 0;
+        if (memcmp(h.magic, SHARD_MAGIC, sizeof(SHARD_MAGIC)) != 0 || h.shardIndex != expected.shardIndex ||
+            h.shardCount != expected.shardCount || h.imageCount != expected.imageCount || h.listHash != expected.listHash) {
+            return 0;
+        }
+        headerOk = true;
+
+        // Sizes in a torn record are garbage: bound them before allocating anything
+        std::error_code ec;
+        uint64_t fileBytes = fs::file_size(path, ec);
+        if (ec) return sizeof(h);
+
+        uint64_t good = sizeof(h);
+        vector<float> floats;
+        while (true) {
+            ShardRecord r;
+            uint32_t pathLen = 0;
+            if (!in.read(reinterpret_cast<char*>(&r.header), sizeof(r.header))) break;
+            if (!in.read(reinterpret_cast<char*>(&pathLen), sizeof(pathLen))) break;
+            if (r.header.index >= h.imageCount || pathLen > 4096) break;
+            if (r.header.index % h.shardCount != h.shardIndex) break; // Belongs to another shard
+
+            r.path.resize(pathLen);
+            if (!in.read(&r.path[0], pathLen)) break;
+            r.floatOffset = good + sizeof(r.header) + sizeof(pathLen) + pathLen;
+
+            uint64_t floatBytes = (uint64_t)r.header.floatCount * sizeof(float);
+            uint64_t expectedFloats = (r.header.status == 0) ? descriptorFloats(r.header.cellsX, r.header.cellsY) : 0;
+            if (r.header.floatCount != expectedFloats) break;
+            if (r.floatOffset + floatBytes + sizeof(uint32_t) > fileBytes) break;
+            floats.resize(r.header.floatCount);
+            if (!in.read(reinterpret_cast<char*>(floats.data()), floats.size() * sizeof(float))) break;
+
+            uint32_t stored = 0;
+            if (!in.read(reinterpret_cast<char*>(&stored), sizeof(stored))) break;
+            uint32_t sum = fnv1a32(&r.header, sizeof(r.header));
+            sum = fnv1a32(&pathLen, sizeof(pathLen), sum);
+            sum = fnv1a32(r.path.data(), pathLen, sum);
+            sum = fnv1a32(floats.data(), floats.size() * sizeof(float), sum);
+            if (sum != stored) break;
+
+            good = r.floatOffset + floats.size() * sizeof(float) + sizeof(stored);
+            records.push_back(std::move(r));
+        }
+        return good;
+    }
+}
+
+vector<string> DatasetShards::listImages(const string& inputDir) {
+    vector<string> files;
+    for (const auto& entry : fs::recursive_directory_iterator(inputDir)) {
+        if (!entry.is_regular_file()) continue;
+        string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext == ".jpg" || ext == ".png" || ext == ".jpeg" || ext == ".bmp") {
+            files.push_back(fs::relative(entry.path(), inputDir).generic_string());
+        }
+    }
+    // Byte-wise order: identical on every machine, whatever the locale
+    sort(files.begin(), files.end());
+    return files;
+}
+
+int DatasetShards::extract(HogDetector* detector, const string& inputDir, const string& outputDir, ShardSpec shard) {
+    cout << "\n=== Sharded Extraction: shard " << shard.index << "/" << shard.count << " ===" << endl;
+    if (shard.count < 1 || shard.index < 0 || shard.index >= shard.count) {
+        cerr << "[Error] Invalid shard " << shard.index << "/" << shard.count << endl;
+        return 1;
+    }
+    if (!fs::is_directory(inputDir)) {
+        cerr << "[Error] Not a directory: " << inputDir << endl;
+        return 1;
+    }
+    if (!fs::exists(outputDir)) fs::create_directories(outputDir);
+
+    string base = (fs::path(outputDir) / shardBaseName(shard)).string();
+    string binPath = base + ".bin";
+    string donePath = base + ".done";
+    if (fs::exists(donePath)) {
+        cout << "[Info] Shard already complete (" << donePath << "), nothing to do." << endl;
+        return 0;
+    }
+
+    vector<string> files = listImages(inputDir);
+    ShardFileHeader header;
+    memcpy(header.magic, SHARD_MAGIC, sizeof(SHARD_MAGIC));
+    header.shardIndex = shard.index;
+    header.shardCount = shard.count;
+    header.imageCount = files.size();
+    header.listHash = hashList(files);
+
+    // Append mode: every write lands at the (possibly truncated) end of the file
+    FILE* out = fopen(binPath.c_str(), "ab");
+    if (!out) {
+        cerr << "[Error] Cannot open " << binPath << endl;
+        return 1;
+    }
+    // Two workers on the same shard would interleave records
+    if (flock(fileno(out), LOCK_EX | LOCK_NB) != 0) {
+        cerr << "[Error] Another worker is already running shard " << shard.index << "/" << shard.count << endl;
+        fclose(out);
+        return 1;
+    }
+
+    // --- Resume: keep committed records, cut off a torn tail ---
+    vector<ShardRecord> committed;
+    bool headerOk = false;
+    uint64_t fileBytes = fs::file_size(binPath);
+    uint64_t validBytes = 0;
+    if (fileBytes >= sizeof(header)) {
+        validBytes = scanShard(binPath, header, committed, headerOk);
+        if (!headerOk) {
+            cerr << "[Error] " << binPath << " was written for another file list or shard layout. "
+                 << "Remove it or use a new output directory." << endl;
+            fclose(out);
+            return 1;
+        }
+    }
+    if (fileBytes > validBytes) {
+        if (headerOk) cout << "[Resume] Dropping " << fileBytes - validBytes << " bytes of an unfinished record." << endl;
+        if (ftruncate(fileno(out), (off_t)validBytes) != 0) {
+            cerr << "[Error] Cannot truncate " << binPath << endl;
+            fclose(out);
+            return 1;
+        }
+    }
+    if (!headerOk) fwrite(&header, sizeof(header), 1, out);
+
+    vector<bool> done(files.size(), false);
+    for (const auto& r : committed) done[r.header.index] = true;
+
+    size_t assigned = 0;
+    for (size_t k = shard.index; k < files.size(); k += shard.count) assigned++;
+    cout << "[Info] " << files.size() << " images in list, " << assigned << " in this shard, "
+         << committed.size() << " already committed." << endl;
+
+    // --- Extract ---
+    vector<float> descriptor;
+    size_t written = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t k = shard.index; k < files.size(); k += shard.count) {
+        if (done[k]) continue;
+
+        FeatureRecordHeader rec = {};
+        rec.index = k;
+        descriptor.clear();
+
+        Mat img = imread((fs::path(inputDir) / files[k]).string());
+        if (img.empty()) {
+            rec.status = 1; // Recorded anyway, so a rerun does not retry it forever
+            cerr << "[Warning] Unreadable image: " << files[k] << endl;
+        } else {
+            detector->computeHOG(img, false);
+            HistogramGrid grid = detector->getHistogramGrid();
+            computeBlockDescriptor(grid, descriptor);
+            rec.cellsX = grid.cellsX;
+            rec.cellsY = grid.cellsY;
+        }
+        rec.floatCount = (uint32_t)descriptor.size();
+
+        uint32_t pathLen = (uint32_t)files[k].size();
+        uint32_t sum = fnv1a32(&rec, sizeof(rec));
+        sum = fnv1a32(&pathLen, sizeof(pathLen), sum);
+        sum = fnv1a32(files[k].data(), pathLen, sum);
+        sum = fnv1a32(descriptor.data(), descriptor.size() * sizeof(float), sum);
+
+        fwrite(&rec, sizeof(rec), 1, out);
+        fwrite(&pathLen, sizeof(pathLen), 1, out);
+        fwrite(files[k].data(), 1, pathLen, out);
+        fwrite(descriptor.data(), sizeof(float), descriptor.size(), out);
+        // The checksum goes last: a record without it is discarded on resume
+        fwrite(&sum, sizeof(sum), 1, out);
+        if (fflush(out) != 0) {
+            cerr << "[Error] Write failed on " << binPath << endl;
+            fclose(out);
+            return 1;
+        }
+        if (++written % FSYNC_EVERY == 0) fsync(fileno(out));
+
+        if (written % PROGRESS_EVERY == 0) {
+            cout << "[Progress] " << committed.size() + written << "/" << assigned << endl;
+        }
+    }
+    fsync(fileno(out));
+    fclose(out);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    double sec = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() / 1000.0;
+    cout << "[Done] " << written << " images in " << sec << " s";
+    if (sec > 0.0) cout << " (" << written / sec << " img/s)";
+    cout << endl;
+
+    // Only now may merge() use this shard. Written aside and renamed, so a crash
+    // never leaves a truncated marker that still counts as complete.
+    string donePartial = donePath + ".tmp";
+    ofstream marker(donePartial);
+    marker << assigned << "\n";
+    marker.close();
+    if (!marker) {
+        cerr << "[Error] Cannot write " << donePartial << endl;
+        return 1;
+    }
+    error_code ec;
+    fs::rename(donePartial, donePath, ec);
+    if (ec) {
+        cerr << "[Error] Cannot rename " << donePartial << " to " << donePath << ": " << ec.message() << endl;
+        return 1;
+    }
+    cout << "[Saved] " << binPath << " (+ " << fs::path(donePath).filename().string() << ")" << endl;
+    return 0;
+}
+
+int DatasetShards::merge(const string& outputDir) {
+    cout << "\n=== Merging Shards: " << outputDir << " ===" << endl;
+    if (!fs::is_directory(outputDir)) {
+        cerr << "[Error] Not a directory: " << outputDir << endl;
+        return 1;
+    }
+
+    // Shard count comes from the file names; every shard file must agree with it
+    int shardCount = 0;
+    for (const auto& entry : fs::directory_iterator(outputDir)) {
+        int i = 0, n = 0;
+        string name = entry.path().filename().string();
+        if (entry.path().extension() == ".bin" && sscanf(name.c_str(), "shard_%d_of_%d", &i, &n) == 2) {
+            if (shardCount && n != shardCount) {
+                cerr << "[Error] Shards from different runs (" << shardCount << " vs " << n << " shards) in " << outputDir << endl;
+                return 1;
+            }
+            shardCount = n;
+        }
+    }
+    if (shardCount == 0) {
+        cerr << "[Error] No shard files in " << outputDir << endl;
+        return 1;
+    }
+
+    // --- Read every shard's committed records ---
+    ShardFileHeader ref = {};
+    vector<vector<ShardRecord>> shardRecords(shardCount);
+    vector<string> shardPaths(shardCount);
+    for (int s = 0; s < shardCount; s++) {
+        string base = (fs::path(outputDir) / shardBaseName({ s, shardCount })).string();
+        shardPaths[s] = base + ".bin";
+        if (!fs::exists(base + ".done")) {
+            cerr << "[Error] Shard " << s << "/" << shardCount << " is not finished (no .done marker). Rerun it first." << endl;
+            return 1;
+        }
+
+        ShardFileHeader h;
+        ifstream in(shardPaths[s], ios::binary);
+        if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)) || memcmp(h.magic, SHARD_MAGIC, sizeof(SHARD_MAGIC)) != 0) {
+            cerr << "[Error] Bad shard file: " << shardPaths[s] << endl;
+            return 1;
+        }
+        if (s == 0) ref = h;
+        else if (h.imageCount != ref.imageCount || h.listHash != ref.listHash) {
+            cerr << "[Error] " << shardPaths[s] << " was built from a different file list." << endl;
+            return 1;
+        }
+
+        bool ok = false;
+        scanShard(shardPaths[s], h, shardRecords[s], ok);
+    }
+
+    // --- Index by image, dedup, check coverage ---
+    struct Location { int shard; const ShardRecord* record; };
+    vector<Location> byIndex(ref.imageCount, { -1, nullptr });
+    size_t duplicates = 0;
+    for (int s = 0; s < shardCount; s++) {
+        for (const auto& r : shardRecords[s]) {
+            if (byIndex[r.header.index].record) { duplicates++; continue; }
+            byIndex[r.header.index] = { s, &r };
+        }
+    }
+    size_t missing = 0;
+    for (const auto& loc : byIndex) if (!loc.record) missing++;
+    if (duplicates) cout << "[Warning] " << duplicates << " duplicate records ignored (first copy kept)." << endl;
+    if (missing) {
+        cerr << "[Error] " << missing << " of " << ref.imageCount << " images have no record. Merge aborted." << endl;
+        return 1;
+    }
+
+    // --- Write features.bin + manifest.csv in index order ---
+    string featuresPath = (fs::path(outputDir) / "features.bin").string();
+    string manifestPath = (fs::path(outputDir) / "manifest.csv").string();
+    ofstream features(featuresPath, ios::binary);
+    ofstream manifest(manifestPath);
+    if (!features || !manifest) {
+        cerr << "[Error] Cannot write merged output in " << outputDir << endl;
+        return 1;
+    }
+
+    FeatureFileHeader fh;
+    memcpy(fh.magic, FEATURE_MAGIC, sizeof(FEATURE_MAGIC));
+    fh.imageCount = ref.imageCount;
+    fh.listHash = ref.listHash;
+    features.write(reinterpret_cast<const char*>(&fh), sizeof(fh));
+    manifest << "Index,Path,Status,CellsX,CellsY,Floats,Offset,Shard\n";
+
+    // A half-written features.bin must not look like a merge result
+    auto abortMerge = [&]() {
+        features.close();
+        manifest.close();
+        fs::remove(featuresPath);
+        fs::remove(manifestPath);
+        cerr << "[Error] Merge aborted, partial output removed." << endl;
+        return 1;
+    };
+
+    vector<ifstream> inputs(shardCount);
+    for (int s = 0; s < shardCount; s++) {
+        inputs[s].open(shardPaths[s], ios::binary);
+        if (!inputs[s]) {
+            cerr << "[Error] Cannot reopen " << shardPaths[s] << endl;
+            return abortMerge();
+        }
+    }
+
+    vector<float> floats;
+    size_t unreadable = 0;
+    for (const auto& loc : byIndex) {
+        const ShardRecord& r = *loc.record;
+        floats.resize(r.header.floatCount);
+        ifstream& in = inputs[loc.shard];
+        streamsize bytes = (streamsize)(floats.size() * sizeof(float));
+        // The shard was scanned above, so anything short here means it changed underneath us
+        if (!in.seekg(r.floatOffset) || !in.read(reinterpret_cast<char*>(floats.data()), bytes) || in.gcount() != bytes) {
+            cerr << "[Error] Short read in " << shardPaths[loc.shard] << " (image " << r.header.index
+                 << ", offset " << r.floatOffset << ")." << endl;
+            return abortMerge();
+        }
+
+        uint64_t offset = (uint64_t)features.tellp();
+        features.write(reinterpret_cast<const char*>(&r.header), sizeof(r.header));
+        features.write(reinterpret_cast<const char*>(floats.data()), floats.size() * sizeof(float));
+        if (r.header.status != 0) unreadable++;
+
+        manifest << r.header.index << ",\"" << r.path << "\"," << r.header.status << "," << r.header.cellsX << ","
+                 << r.header.cellsY << "," << r.header.floatCount << "," << offset << "," << loc.shard << "\n";
+    }
+    features.flush();
+    manifest.flush();
+    if (!features || !manifest) {
+        cerr << "[Error] Write failed on " << featuresPath << " or " << manifestPath << endl;
+        return abortMerge();
+    }
+
+    cout << "[Done] " << ref.imageCount << " images from " << shardCount << " shards";
+    if (unreadable) cout << " (" << unreadable << " unreadable, kept with status 1)";
+    cout << endl;
+    cout << "[Saved] " << featuresPath << " and " << manifestPath << endl;
+    return 0;
+}
@@ -0,0 +1,227 @@
+#include "../../include/TrainingWindows.h"
+#include "../../include/DatasetShards.h"
+#include "../../include/HogDetector.h"
+#include "../../include/Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <omp.h>
+#include <random>
+
+using namespace cv;
+using namespace std;
+namespace fs = std::filesystem;
+
+// ==========================================
+// CONFIGURATION
+// ==========================================
+// Windows per batch: bounds memory (batch x descriptor floats) and the I/O granularity.
+static constexpr int BATCH_WINDOWS = 2048;
+
+// Negative window sizes, as multiples of the 64x128 detection window.
+static constexpr double NEGATIVE_SCALES[] = { 1.0, 1.5, 2.0, 3.0 };
+// ==========================================
+
+namespace {
+    struct WindowJob {
+        Mat window; // Owned 64x128 copy: the source image is released as soon as it is cut
+        int32_t label;
+    };
+
+    // Fixed-width rows streamed behind a header whose row count is patched at the end.
+    // Any failed write (full disk, failed header rewrite) leaves ok() false for good.
+    class MatrixFile {
+    public:
+        MatrixFile(const string& path, const char (&magic)[8], uint32_t cols) : file(path, ios::binary) {
+            memcpy(header.magic, magic, sizeof(header.magic));
+            header.rows = 0;
+            header.cols = cols;
+            header.reserved = 0;
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        bool ok() const { return !file.fail(); }
+
+        bool append(const void* data, size_t rows, size_t rowBytes) {
+            file.write(static_cast<const char*>(data), rows * rowBytes);
+            if (file.good()) header.rows += rows;
+            return file.good();
+        }
+
+        // close() flushes, so only its outcome says whether the data reached the file
+        bool finish() {
+            file.seekp(0);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.close();
+            return !file.fail();
+        }
+
+    private:
+        ofstream file;
+        TrainingWindows::MatrixHeader header;
+    };
+
+    // Per-image generator: depends only on (seed, image index), not on batch or thread order.
+    mt19937_64 imageRng(uint64_t seed, size_t index) {
+        seed_seq seq{ (uint32_t)seed, (uint32_t)(seed >> 32), (uint32_t)index, (uint32_t)((uint64_t)index >> 32) };
+        return mt19937_64(seq);
+    }
+
+    // Crop of 'img' scaled to the detection window, never sharing the source buffer.
+    Mat cutWindow(const Mat& img, const Rect& roi, const Size& winSize) {
+        Mat crop = img(roi);
+        if (crop.size() == winSize) return crop.clone();
+        Mat window;
+        resize(crop, window, winSize, 0, 0, INTER_AREA);
+        return window;
+    }
+
+    void sampleNegatives(const Mat& img, int count, mt19937_64& rng, vector<Rect>& rois) {
+        vector<Size> fitting;
+        for (double s : NEGATIVE_SCALES) {
+            Size win((int)(Utils::WIN_WIDTH * s), (int)(Utils::WIN_HEIGHT * s));
+            if (win.width <= img.cols && win.height <= img.rows) fitting.push_back(win);
+        }
+        if (fitting.empty()) return;
+
+        for (int i = 0; i < count; i++) {
+            Size win = fitting[uniform_int_distribution<size_t>(0, fitting.size() - 1)(rng)];
+            int x = uniform_int_distribution<int>(0, img.cols - win.width)(rng);
+            int y = uniform_int_distribution<int>(0, img.rows - win.height)(rng);
+            rois.push_back(Rect(x, y, win.width, win.height));
+        }
+    }
+}
+
+int TrainingWindows::extract(const DetectorFactory& factory, const string& positiveDir,
+                             const string& negativeDir, const TrainingOptions& options) {
+    cout << "\n=== Training Window Extraction ===" << endl;
+    if (!fs::is_directory(positiveDir) || !fs::is_directory(negativeDir)) {
+        cerr << "[Error] Positive and negative paths must both be directories." << endl;
+        return 1;
+    }
+
+    vector<string> positives = DatasetShards::listImages(positiveDir);
+    vector<string> negatives = DatasetShards::listImages(negativeDir);
+    cout << "[Info] " << positives.size() << " positive images, " << negatives.size() << " negative images x "
+         << options.negativesPerImage << " windows (seed " << options.seed << ")" << endl;
+
+    // --- One detector per worker ---
+    int threads = options.threads > 0 ? options.threads : omp_get_max_threads();
+    vector<unique_ptr<HogDetector>> detectors;
+    for (int t = 0; t < threads; t++) {
+        HogDetector* d = factory();
+        if (!d) return 1;
+        detectors.emplace_back(d);
+    }
+
+    const Size winSize(Utils::WIN_WIDTH, Utils::WIN_HEIGHT);
+    const int cols = (int)detectors[0]->getFeatureCount(winSize);
+
+    if (!fs::exists(options.outputDir)) fs::create_directories(options.outputDir);
+    string featuresPath = (fs::path(options.outputDir) / "features.bin").string();
+    string labelsPath = (fs::path(options.outputDir) / "labels.bin").string();
+    MatrixFile features(featuresPath, FEATURES_MAGIC, (uint32_t)cols);
+    MatrixFile labels(labelsPath, LABELS_MAGIC, 1);
+    if (!features.ok() || !labels.ok()) {
+        cerr << "[Error] Cannot write to " << options.outputDir << endl;
+        return 1;
+    }
+
+    // Batch buffers, reused. Jobs hold only window-sized crops, so memory stays
+    // flat (BATCH_WINDOWS x 64x128 pixels) whatever the source resolution.
+    vector<WindowJob> jobs;
+    vector<float> rows((size_t)BATCH_WINDOWS * cols);
+    vector<int32_t> rowLabels(BATCH_WINDOWS);
+    vector<char> valid(BATCH_WINDOWS);
+
+    size_t positiveRows = 0, negativeRows = 0, skipped = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // Computes every queued window in parallel, then appends the batch in job order.
+    // False once a write has failed.
+    auto flushBatch = [&]() {
+        int n = (int)jobs.size();
+        #pragma omp parallel num_threads(threads)
+        {
+            HogDetector* detector = detectors[omp_get_thread_num()].get();
+            vector<float> descriptor;
+
+            #pragma omp for schedule(dynamic, 16)
+            for (int j = 0; j < n; j++) {
+                detector->computeHOG(jobs[j].window, false);
+                computeBlockDescriptor(detector->getHistogramGrid(), descriptor);
+                valid[j] = ((int)descriptor.size() == cols);
+                if (valid[j]) std::copy(descriptor.begin(), descriptor.end(), rows.begin() + (size_t)j * cols);
+            }
+        }
+
+        // Compact the valid rows so the matrix has no holes
+        int kept = 0;
+        for (int j = 0; j < n; j++) {
+            if (!valid[j]) { skipped++; continue; }
+            if (kept != j) std::copy_n(rows.begin() + (size_t)j * cols, cols, rows.begin() + (size_t)kept * cols);
+            rowLabels[kept] = jobs[j].label;
+            (jobs[j].label > 0 ? positiveRows : negativeRows)++;
+            kept++;
+        }
+        bool written = features.append(rows.data(), kept, cols * sizeof(float));
+        written = labels.append(rowLabels.data(), kept, sizeof(int32_t)) && written;
+
+        jobs.clear();
+        return written;
+    };
+
+    // Images are read sequentially; a batch is flushed whenever the row buffer is full,
+    // also in the middle of one image's negatives. False once a write has failed.
+    auto addImages = [&](const string& dir, const vector<string>& files, bool positive) {
+        for (size_t i = 0; i < files.size(); i++) {
+            Mat img = imread((fs::path(dir) / files[i]).string());
+            if (img.empty()) {
+                cerr << "[Warning] Unreadable image: " << files[i] << endl;
+                skipped++;
+                continue;
+            }
+
+            vector<Rect> rois;
+            if (positive) {
+                rois.push_back(Rect(0, 0, img.cols, img.rows));
+            } else {
+                mt19937_64 rng = imageRng(options.seed, i);
+                sampleNegatives(img, options.negativesPerImage, rng, rois);
+                if (rois.empty()) skipped++; // Smaller than one window
+            }
+            for (const Rect& roi : rois) {
+                if ((int)jobs.size() == BATCH_WINDOWS && !flushBatch()) return false;
+                jobs.push_back({ cutWindow(img, roi, winSize), positive ? +1 : -1 });
+            }
+            // 'img' goes out of scope here: only the windows cut from it stay in the batch
+        }
+        return true;
+    };
+
+    bool written = addImages(positiveDir, positives, true) && addImages(negativeDir, negatives, false);
+    if (written && !jobs.empty()) written = flushBatch();
+    written = features.finish() && written;
+    written = labels.finish() && written;
+    if (!written) {
+        cerr << "[Error] Write failed on " << featuresPath << " or " << labelsPath
+             << " (disk full?). The matrix is incomplete." << endl;
+        return 1;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    double sec = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() / 1000.0;
+    size_t total = positiveRows + negativeRows;
+    cout << "[Done] " << total << " windows (" << positiveRows << " positive, " << negativeRows << " negative) x "
+         << cols << " features in " << sec << " s";
+    if (sec > 0.0) cout << " (" << total / sec << " windows/s, " << threads << " workers)";
+    cout << endl;
+    if (skipped) cout << "[Info] " << skipped << " images/windows skipped (unreadable or too small)." << endl;
+    cout << "[Saved] " << featuresPath << " and " << labelsPath << endl;
+    return 0;
+}
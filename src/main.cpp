@@ -1,8 +1,15 @@
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <string>
-#include "../include/HogSequential.h"
-#include "../include/HogOpenMP.h"
+#include <vector>
+#include "../include/HogCPU.h"
 #include "../include/HogOpenCL.h"
+#include "../include/HogOpenCVRef.h"
+#include "../include/BackendComparison.h"
+#include "../include/DatasetShards.h"
+#include "../include/StreamServer.h"
+#include "../include/TrainingWindows.h"
 #include "../include/Utils.h"
 
 // Only include CUDA header if CMake found the toolkit
@@ -10,50 +17,255 @@
 #include "../include/HogCUDA.h"
 #endif
 
-int main(int argc, char** argv) {
-    std::string input = (argc > 1) ? argv[1] : "../assets/image.jpg";
-    int mode = (argc > 2) ? std::stoi(argv[2]) : 0;
-
-    HogDetector* detector = nullptr;
-    std::string name;
-    std::string csvName;
-
+// Returns nullptr when the mode is not available in this build.
+static HogDetector* createDetector(int mode, std::string& name, std::string& csvName) {
     switch (mode) {
         case 1:
-            std::cout << "[Mode] OpenMP Parallel CPU" << std::endl;
-            detector = new HogOpenMP();
             name = "OpenMP CPU";
             csvName = "OpenMP.csv";
-            break;
+            return new HogOpenMP();
         case 2:
-            std::cout << "[Mode] OpenCL GPU" << std::endl;
-            detector = new HogOpenCL();
             name = "OpenCL GPU";
             csvName = "OpenCL.csv";
-            break;
+            return new HogOpenCL();
         case 3:
             #ifdef USE_CUDA
-                std::cout << "[Mode] CUDA NVIDIA GPU" << std::endl;
-                detector = new HogCUDA();
                 name = "CUDA GPU";
                 csvName = "CUDA.csv";
+                return new HogCUDA();
             #else
                 std::cerr << "[Error] This executable was compiled without CUDA support." << std::endl;
-                return 1;
+                return nullptr;
             #endif
-            break;
+        case 4:
+            name = "StdPar CPU";
+            csvName = "StdPar.csv";
+            return new HogStdPar();
+        case 5:
+            name = "Tasks CPU";
+            csvName = "Tasks.csv";
+            return new HogTasks();
+        case 6:
+            name = "OpenCV Reference";
+            csvName = "OpenCV.csv";
+            return new HogOpenCVRef();
         default:
-            std::cout << "[Mode] Sequential CPU" << std::endl;
-            detector = new HogSequential();
             name = "Sequential CPU";
             csvName = "Sequential.csv";
-            break;
+            return new HogSequential();
     }
-    
-    if (detector) {
-        Utils::runBenchmarkTask(detector, input, name, csvName);
-        delete detector;
+}
+
+// Usage: HOG_App --streams <mode> <source1> [source2 ...]
+static int runStreams(int argc, char** argv) {
+    int mode = (argc > 2) ? std::stoi(argv[2]) : 0;
+    std::vector<std::string> sources(argv + std::min(argc, 3), argv + argc);
+
+    std::string name, csvName;
+    HogDetector* probe = createDetector(mode, name, csvName);
+    if (!probe) return 1;
+    delete probe;
+
+    std::cout << "[Mode] Multi-Stream " << name << std::endl;
+    StreamServer server([mode]() {
+        std::string n, c;
+        return createDetector(mode, n, c);
+    });
+    server.run(sources);
+    return 0;
+}
+
+// Usage: HOG_App --compare <input>
+// Every backend available in this build vs the OpenCV reference, on identical frames.
+static int runCompare(int argc, char** argv) {
+    std::string input = (argc > 2) ? argv[2] : "../assets/image.jpg";
+
+    std::vector<ComparedBackend> backends;
+    std::vector<int> modes = { 6, 0, 1, 4, 5, 2, 3 }; // Reference first
+    for (int mode : modes) {
+        #ifdef USE_CUDA
+            if (mode == 3 && !HogCUDA::isAvailable()) {
+                std::cout << "[Skip] CUDA GPU: no CUDA device" << std::endl;
+                continue;
+            }
+        #endif
+        std::string name, csvName;
+        try {
+            HogDetector* d = createDetector(mode, name, csvName);
+            if (d) backends.push_back({ name, d });
+        } catch (const std::exception& e) {
+            std::cout << "[Skip] " << name << ": " << e.what() << std::endl;
+        }
+    }
+
+    BackendComparison::run(backends, input);
+    for (auto& b : backends) delete b.detector;
+    return 0;
+}
+
+// Usage: HOG_App --extract <imageDir> <mode> [--shard i/n] [--out <dir>]
+// One worker process per shard; rerun a crashed shard with the same arguments.
+static int runExtract(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "[Error] Usage: --extract <imageDir> <mode> [--shard i/n] [--out <dir>]" << std::endl;
+        return 1;
+    }
+    std::string inputDir = argv[2];
+    int mode = (argc > 3) ? std::stoi(argv[3]) : 0;
+    std::string outputDir = "../results/features/";
+    ShardSpec shard;
+    for (int i = 4; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--shard" && i + 1 < argc) {
+            if (sscanf(argv[++i], "%d/%d", &shard.index, &shard.count) != 2) {
+                std::cerr << "[Error] --shard expects i/n, e.g. 0/4" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--out" && i + 1 < argc) {
+            outputDir = argv[++i];
+        } else {
+            std::cerr << "[Warning] Unknown option ignored: " << arg << std::endl;
+        }
+    }
+
+    std::string name, csvName;
+    HogDetector* detector = createDetector(mode, name, csvName);
+    if (!detector) return 1;
+    std::cout << "[Mode] " << name << std::endl;
+    int rc = DatasetShards::extract(detector, inputDir, outputDir, shard);
+    delete detector;
+    return rc;
+}
+
+// Usage: HOG_App --train-windows <positiveDir> <negativeDir> <mode>
+//                [--neg-per-image N] [--seed S] [--threads T] [--out <dir>]
+static int runTrainingWindows(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "[Error] Usage: --train-windows <positiveDir> <negativeDir> <mode> "
+                  << "[--neg-per-image N] [--seed S] [--threads T] [--out <dir>]" << std::endl;
+        return 1;
+    }
+    std::string positiveDir = argv[2];
+    std::string negativeDir = argv[3];
+    int mode = (argc > 4) ? std::stoi(argv[4]) : 0;
+
+    TrainingOptions options;
+    for (int i = 5; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--neg-per-image" && i + 1 < argc) {
+            options.negativesPerImage = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::stoull(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.threads = std::stoi(argv[++i]);
+        } else if (arg == "--out" && i + 1 < argc) {
+            options.outputDir = argv[++i];
+        } else {
+            std::cerr << "[Warning] Unknown option ignored: " << arg << std::endl;
+        }
+    }
+    // GPU backends already saturate the device from one worker
+    if ((mode == 2 || mode == 3) && options.threads == 0) options.threads = 1;
+
+    std::string name, csvName;
+    HogDetector* probe = createDetector(mode, name, csvName);
+    if (!probe) return 1;
+    delete probe;
+
+    std::cout << "[Mode] " << name << std::endl;
+    return TrainingWindows::extract([mode]() {
+        std::string n, c;
+        return createDetector(mode, n, c);
+    }, positiveDir, negativeDir, options);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--streams") return runStreams(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "--compare") return runCompare(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "--extract") return runExtract(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "--train-windows") return runTrainingWindows(argc, argv);
+    // Usage: HOG_App --merge [<dir>] (after every shard of --extract is done)
+    if (argc > 1 && std::string(argv[1]) == "--merge") return DatasetShards::merge((argc > 2) ? argv[2] : "../results/features/");
+
+    std::string input = (argc > 1) ? argv[1] : "../assets/image.jpg";
+    int mode = (argc > 2) ? std::stoi(argv[2]) : 0;
+
+    // Optional flags after <input> <mode>
+    BenchmarkOptions options;
+    std::vector<HistogramLayout> layouts; // Empty = default layout, no layout suffix
+    bool autotune = false;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--budget" && i + 1 < argc) {
+            options.latencyBudgetMs = std::stod(argv[++i]);
+        } else if (arg == "--layout" && i + 1 < argc) {
+            std::string which = argv[++i];
+            if (which == "cell" || which == "both") layouts.push_back(HistogramLayout::CellMajor);
+            if (which == "padded" || which == "both") layouts.push_back(HistogramLayout::Padded16);
+            options.timeDescriptor = true;
+        } else if (arg == "--shm" && i + 1 < argc) {
+            options.shmName = argv[++i];
+        } else if (arg == "--shm-slots" && i + 1 < argc) {
+            options.shmSlots = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--shm-max" && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &options.shmMaxFrame.width, &options.shmMaxFrame.height) != 2) {
+                std::cerr << "[Error] --shm-max expects <W>x<H>, e.g. 1920x1080" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--shm-replace") {
+            options.shmReplace = true;
+        } else if (arg == "--cascade" && i + 1 < argc) {
+            options.cascadeThreshold = std::stod(argv[++i]);
+        } else if (arg == "--cache" && i + 1 < argc) {
+            options.cacheBudgetMB = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--autotune") {
+            autotune = true;
+        } else {
+            std::cerr << "[Warning] Unknown option ignored: " << arg << std::endl;
+        }
+    }
+
+    std::string name;
+    std::string csvName;
+    HogDetector* detector = createDetector(mode, name, csvName);
+    if (!detector) return 1;
+
+    // Sweep launch configurations first; the benchmark below then runs on the winner
+    if (autotune) {
+        if (HogOpenCL* opencl = dynamic_cast<HogOpenCL*>(detector)) opencl->autotune();
+        else std::cerr << "[Warning] --autotune only applies to mode 2 (OpenCL), ignored." << std::endl;
+    }
+
+    // Adaptive runs get their own CSV so they don't overwrite the full-quality baseline
+    if (options.latencyBudgetMs > 0.0) {
+        name += " (Adaptive)";
+        csvName.insert(csvName.rfind('.'), "_Adaptive");
+    }
+    if (options.cascadeThreshold > 0.0) {
+        name += " (Cascade)";
+        csvName.insert(csvName.rfind('.'), "_Cascade");
+    }
+    if (options.cacheBudgetMB > 0) {
+        name += " (Cached)";
+        csvName.insert(csvName.rfind('.'), "_Cached");
+    }
+
+    std::cout << "[Mode] " << name << std::endl;
+    if (layouts.empty()) {
+        Utils::runBenchmarkTask(detector, input, name, csvName, options);
+    } else {
+        // One run per layout on the same detector, e.g. OpenMP_CellMajor.csv vs OpenMP_Padded16.csv
+        for (HistogramLayout layout : layouts) {
+            bool padded = (layout == HistogramLayout::Padded16);
+            std::string suffix = padded ? "_Padded16" : "_CellMajor";
+            std::string layoutCsv = csvName;
+            layoutCsv.insert(layoutCsv.rfind('.'), suffix);
+
+            options.layout = layout;
+            Utils::runBenchmarkTask(detector, input, name + (padded ? " [Padded16]" : " [CellMajor]"), layoutCsv, options);
+        }
     }
+    delete detector;
 
     return 0;
 }
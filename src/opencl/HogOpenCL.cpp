@@ -1,9 +1,11 @@
 #include "../../include/HogOpenCL.h"
+#include "../../include/HogVisualizer.h"
 #include <iostream>
 #include <vector>
 #include <stdexcept>
 #include <cmath>
 #include <cstring> 
+#include <algorithm>
 
 using namespace cv;
 using namespace std;
@@ -17,22 +19,56 @@ static const char* KERNEL_SOURCE = R"(
     #define PI 3.14159265359f
     #define MAG_THRESHOLD 0.1f
 
-    __kernel void compute_hog_fused(
-        __global const uchar* img,    
-        __global float* hist,         
-        int rows, 
-        int cols,
-        int step,                     
-        float binScale
-    ) {
-        // Thread Mapping: 1 Thread = 1 Cell
-        int cx = get_global_id(0);
-        int cy = get_global_id(1);
-        int cellsX = get_global_size(0);
+    // Launch shape, injected by the host with -D (see OpenCLLaunchConfig)
+    #ifndef CELLS_PER_ITEM
+    #define CELLS_PER_ITEM 1
+    #endif
+    #ifndef VEC_WIDTH
+    #define VEC_WIDTH 1
+    #endif
+
+    #define CAT_(a, b) a##b
+    #define CAT(a, b) CAT_(a, b)
+
+    // Soft-binning of one gradient into the private histogram
+    inline void bin_gradient(float* localHist, float m, float angle, float binScale) {
+        if (angle < 0) angle += 360.0f;
+        if (angle >= 180.0f) angle -= 180.0f;
+        
+        float exactBin = angle * binScale;
+        int b0 = (int)exactBin;
+        if (b0 >= BIN_COUNT) b0 = 0;
         
-        // Bounds Check
-        if (cx * CELL_WIDTH >= cols || cy * CELL_HEIGHT >= rows) return;
+        int b1 = b0 + 1;
+        if (b1 >= BIN_COUNT) b1 = 0;
+        
+        float w1 = exactBin - b0;
+        float w0 = 1.0f - w1;
+
+        // Accumulate to registers
+        localHist[b0] += m * w0;
+        localHist[b1] += m * w1;
+    }
 
+    #if VEC_WIDTH > 1
+    typedef CAT(float, VEC_WIDTH) floatv;
+    typedef CAT(int, VEC_WIDTH) intv;
+    #define VLOAD CAT(vload, VEC_WIDTH)
+    #define VSTORE CAT(vstore, VEC_WIDTH)
+    #endif
+
+    inline void compute_cell(
+        __global const uchar* img,
+        __global float* hist,
+        int rows,
+        int cols,
+        int step,
+        float binScale,
+        int rowStep,
+        int cellsX,
+        int cx,
+        int cy
+    ) {
         // Private Memory (Registers) - Fastest access possible
         float localHist[BIN_COUNT];
         for(int i=0; i<BIN_COUNT; i++) localHist[i] = 0.0f;
@@ -40,11 +76,14 @@ static const char* KERNEL_SOURCE = R"(
         int startY = cy * CELL_HEIGHT;
         int startX = cx * CELL_WIDTH;
         
+        float rowWeight = (float)rowStep;
+
         // Loop over the 8x8 pixels in this cell
-        for (int dy = 0; dy < CELL_HEIGHT; dy++) {
+        for (int dy = 0; dy < CELL_HEIGHT; dy += rowStep) {
             int y = startY + dy;
             if (y <= 0 || y >= rows - 1) continue; 
-            
+
+    #if VEC_WIDTH == 1
             for (int dx = 0; dx < CELL_WIDTH; dx++) {
                 int x = startX + dx;
                 if (x <= 0 || x >= cols - 1) continue;
@@ -77,23 +116,52 @@ static const char* KERNEL_SOURCE = R"(
 
                 // Fast angle calculation
                 float angle = atan2(bestDy, bestDx) * (180.0f / PI);
-                if (angle < 0) angle += 360.0f;
-                if (angle >= 180.0f) angle -= 180.0f;
-                
-                float exactBin = angle * binScale;
-                int b0 = (int)exactBin;
-                if (b0 >= BIN_COUNT) b0 = 0;
-                
-                int b1 = b0 + 1;
-                if (b1 >= BIN_COUNT) b1 = 0;
-                
-                float w1 = exactBin - b0;
-                float w0 = 1.0f - w1;
+                bin_gradient(localHist, m * rowWeight, angle, binScale);
+            }
+    #else
+            __global const uchar* row = img + y * step;
+            __global const uchar* up = row - step;
+            __global const uchar* down = row + step;
+
+            // VEC_WIDTH pixels per step: sqrt/atan2 run on vectors, binning stays scalar
+            for (int dx = 0; dx < CELL_WIDTH; dx += VEC_WIDTH) {
+                float gx[3][VEC_WIDTH];
+                float gy[3][VEC_WIDTH];
+                for (int i = 0; i < VEC_WIDTH; i++) {
+                    // Border lanes read a clamped pixel and are dropped below
+                    int x = clamp(startX + dx + i, 1, cols - 2);
+                    for (int c = 0; c < 3; c++) {
+                        gx[c][i] = (float)row[(x + 1) * 3 + c] - (float)row[(x - 1) * 3 + c];
+                        gy[c][i] = (float)down[x * 3 + c] - (float)up[x * 3 + c];
+                    }
+                }
+
+                // Strongest channel per lane (first one wins ties, as in the scalar path)
+                floatv bestDx = VLOAD(0, gx[0]);
+                floatv bestDy = VLOAD(0, gy[0]);
+                floatv maxGradSq = bestDx * bestDx + bestDy * bestDy;
+                for (int c = 1; c < 3; c++) {
+                    floatv cdx = VLOAD(0, gx[c]);
+                    floatv cdy = VLOAD(0, gy[c]);
+                    floatv gradSq = cdx * cdx + cdy * cdy;
+                    intv better = gradSq > maxGradSq;
+                    maxGradSq = select(maxGradSq, gradSq, better);
+                    bestDx = select(bestDx, cdx, better);
+                    bestDy = select(bestDy, cdy, better);
+                }
+
+                float m[VEC_WIDTH];
+                float angle[VEC_WIDTH];
+                VSTORE(sqrt(maxGradSq), 0, m);
+                VSTORE(atan2(bestDy, bestDx) * (180.0f / PI), 0, angle);
 
-                // Accumulate to registers
-                localHist[b0] += m * w0;
-                localHist[b1] += m * w1;
+                for (int i = 0; i < VEC_WIDTH; i++) {
+                    int x = startX + dx + i;
+                    if (x <= 0 || x >= cols - 1 || m[i] < MAG_THRESHOLD) continue;
+                    bin_gradient(localHist, m[i] * rowWeight, angle[i], binScale);
+                }
             }
+    #endif
         }
 
         // Write Final Result to VRAM
@@ -102,6 +170,30 @@ static const char* KERNEL_SOURCE = R"(
             hist[cellIdx + i] = localHist[i];
         }
     }
+
+    __kernel void compute_hog_fused(
+        __global const uchar* img,    
+        __global float* hist,         
+        int rows, 
+        int cols,
+        int step,                     
+        float binScale,
+        int rowStep,                  // Adaptive quality: visit every rowStep-th row
+        int cellsX,
+        int cellsY
+    ) {
+        // Thread Mapping: 1 Thread = CELLS_PER_ITEM horizontally adjacent cells.
+        // The global size is padded up to the work-group shape, hence the bounds checks.
+        int firstCx = get_global_id(0) * CELLS_PER_ITEM;
+        int cy = get_global_id(1);
+        if (cy >= cellsY) return;
+
+        for (int k = 0; k < CELLS_PER_ITEM; k++) {
+            int cx = firstCx + k;
+            if (cx >= cellsX) return;
+            compute_cell(img, hist, rows, cols, step, binScale, rowStep, cellsX, cx, cy);
+        }
+    }
 )";
 
 // --- C++ HOST IMPLEMENTATION ---
@@ -117,7 +209,10 @@ HogOpenCL::HogOpenCL() : HogDetector() {
 }
 
 HogOpenCL::~HogOpenCL() {
+    waitForPending();
     cleanup();
+    if (kernelHog) clReleaseKernel(kernelHog);
+    if (program) clReleaseProgram(program);
     if (queue) clReleaseCommandQueue(queue);
     if (context) clReleaseContext(context);
 }
@@ -181,6 +276,7 @@ void HogOpenCL::initOpenCL() {
     clGetDeviceInfo(bestDevice, CL_DEVICE_NAME, 128, name, NULL);
     std::cout << "[OpenCL] Selected Device: " << name << std::endl;
 
+    device = bestDevice;
     context = clCreateContext(NULL, 1, &bestDevice, NULL, NULL, &err);
     CHECK_CL(err, "Create Context");
     queue = clCreateCommandQueue(context, bestDevice, 0, &err);
@@ -188,47 +284,96 @@ void HogOpenCL::initOpenCL() {
 }
 
 void HogOpenCL::compileKernels() {
+    // A tuning file from an earlier --autotune run on this device wins over the defaults
+    OpenCLLaunchConfig tuned;
+    if (loadTuning(tuned)) {
+        if (buildKernel(tuned, program, kernelHog, false)) {
+            launch = tuned;
+            std::cout << "[OpenCL] Tuned launch: " << launch.describe() << " (" << tuningFile() << ")" << std::endl;
+            return;
+        }
+        std::cerr << "[Warning] Tuned launch rejected by the device, using defaults: " << tuned.describe() << std::endl;
+    }
+
+    launch = OpenCLLaunchConfig();
+    if (!buildKernel(launch, program, kernelHog, true)) {
+        throw std::runtime_error("OpenCL Kernel Build Failed");
+    }
+}
+
+bool HogOpenCL::buildKernel(const OpenCLLaunchConfig& config, cl_program& outProgram, cl_kernel& outKernel, bool reportErrors) {
     cl_int err;
     size_t len = strlen(KERNEL_SOURCE);
-    program = clCreateProgramWithSource(context, 1, &KERNEL_SOURCE, &len, &err);
+    cl_program prog = clCreateProgramWithSource(context, 1, &KERNEL_SOURCE, &len, &err);
     CHECK_CL(err, "Create Program");
 
     // OPTIMIZATION: "-cl-fast-relaxed-math" enables hardware native instructions
-    err = clBuildProgram(program, 0, NULL, "-cl-fast-relaxed-math", NULL, NULL);
+    std::string options = "-cl-fast-relaxed-math -D CELLS_PER_ITEM=" + std::to_string(config.cellsPerItem) +
+                          " -D VEC_WIDTH=" + std::to_string(config.vectorWidth);
+    err = clBuildProgram(prog, 1, &device, options.c_str(), NULL, NULL);
     
     if (err != CL_SUCCESS) {
-        size_t logSize;
-        cl_device_id dev;
-        clGetContextInfo(context, CL_CONTEXT_DEVICES, sizeof(dev), &dev, NULL);
-        clGetProgramBuildInfo(program, dev, CL_PROGRAM_BUILD_LOG, 0, NULL, &logSize);
-        std::vector<char> log(logSize);
-        clGetProgramBuildInfo(program, dev, CL_PROGRAM_BUILD_LOG, logSize, log.data(), NULL);
-        std::cerr << "[OpenCL Build Error]: " << log.data() << std::endl;
-        throw std::runtime_error("OpenCL Kernel Build Failed");
+        if (reportErrors) {
+            size_t logSize;
+            clGetProgramBuildInfo(prog, device, CL_PROGRAM_BUILD_LOG, 0, NULL, &logSize);
+            std::vector<char> log(logSize);
+            clGetProgramBuildInfo(prog, device, CL_PROGRAM_BUILD_LOG, logSize, log.data(), NULL);
+            std::cerr << "[OpenCL Build Error]: " << log.data() << std::endl;
+        }
+        clReleaseProgram(prog);
+        return false;
     }
 
-    kernelHog = clCreateKernel(program, "compute_hog_fused", &err);
-    CHECK_CL(err, "Create Kernel");
+    cl_kernel kernel = clCreateKernel(prog, "compute_hog_fused", &err);
+    if (err != CL_SUCCESS) {
+        clReleaseProgram(prog);
+        CHECK_CL(err, "Create Kernel");
+    }
+
+    // The work-group shape must fit this kernel's register/local-memory budget on this device
+    size_t maxGroup = 0;
+    clGetKernelWorkGroupInfo(kernel, device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(maxGroup), &maxGroup, NULL);
+    if ((size_t)config.localX * config.localY > maxGroup) {
+        clReleaseKernel(kernel);
+        clReleaseProgram(prog);
+        return false;
+    }
+
+    outProgram = prog;
+    outKernel = kernel;
+    return true;
 }
 
 void HogOpenCL::allocateBuffers(int width, int height) {
     if (width == currentWidth && height == currentHeight) return;
-    cleanup();
 
-    currentWidth = width;
-    currentHeight = height;
-    
-    size_t pixelBytes = width * height * 3;
+    size_t pixelBytes = (size_t)width * height * 3;
     int cellsX = width / CELL_WIDTH;
     int cellsY = height / CELL_HEIGHT;
-    size_t histBytes = cellsX * cellsY * BIN_COUNT * sizeof(float);
+    size_t histBytes = (size_t)cellsX * cellsY * BIN_COUNT * sizeof(float);
+
+    currentWidth = width;
+    currentHeight = height;
+    cellHistograms.resize((size_t)cellsX * cellsY * BIN_COUNT);
+
+    // Buffers only grow: alternating sizes (e.g. cascade regions) reuse them
+    if (pixelBytes <= inputCapacity && histBytes <= histCapacity) return;
+
+    size_t newInputCapacity = std::max(pixelBytes, inputCapacity);
+    size_t newHistCapacity = std::max(histBytes, histCapacity);
+
+    // Frames still queued use the old buffers
+    clFinish(queue);
+    cleanup();
+
+    inputCapacity = newInputCapacity;
+    histCapacity = newHistCapacity;
 
     cl_int err;
-    d_input = clCreateBuffer(context, CL_MEM_READ_ONLY, pixelBytes, NULL, &err);
-    d_hist = clCreateBuffer(context, CL_MEM_WRITE_ONLY, histBytes, NULL, &err);
+    d_input = clCreateBuffer(context, CL_MEM_READ_ONLY, inputCapacity, NULL, &err);
+    CHECK_CL(err, "Buffer Allocation");
+    d_hist = clCreateBuffer(context, CL_MEM_WRITE_ONLY, histCapacity, NULL, &err);
     CHECK_CL(err, "Buffer Allocation");
-    
-    cellHistograms.resize(cellsX * cellsY * BIN_COUNT);
 }
 
 void HogOpenCL::cleanup() {
@@ -236,44 +381,147 @@ void HogOpenCL::cleanup() {
     if (d_hist) clReleaseMemObject(d_hist);
     d_input = NULL;
     d_hist = NULL;
+    inputCapacity = 0;
+    histCapacity = 0;
 }
 
 cv::Mat HogOpenCL::computeHOG(const cv::Mat& input, bool visualize) {
-    cl_int err;
     Mat img = input.isContinuous() ? input : input.clone();
     
     allocateBuffers(img.cols, img.rows);
+    enqueueFrame(img, cellHistograms.data(), CL_TRUE, NULL);
+
+    if (visualize) return HogVisualizer::render(getHistogramGrid(), img);
+    return Mat();
+}
+
+// Upload -> kernel -> read on the in-order queue.
+// Non-blocking calls keep 'img' and 'hostHist' in use until 'readDone' completes.
+void HogOpenCL::enqueueFrame(const Mat& img, float* hostHist, cl_bool blocking, cl_event* readDone) {
+    cl_int err;
 
     // 1. Upload Image
-    err = clEnqueueWriteBuffer(queue, d_input, CL_TRUE, 0, 
+    err = clEnqueueWriteBuffer(queue, d_input, blocking, 0, 
                                img.total() * img.elemSize(), img.data, 0, NULL, NULL);
+    CHECK_CL(err, "Upload");
     
     int cellsX = img.cols / CELL_WIDTH;
     int cellsY = img.rows / CELL_HEIGHT;
-    size_t globalSize[2] = { (size_t)cellsX, (size_t)cellsY };
-    
-    int rows = img.rows;
-    int cols = img.cols;
-    int step = (int)img.step;
+
+    // 2. Launch Kernel
+    launchKernel(queue, kernelHog, launch, img.cols, img.rows, (int)img.step, NULL);
+
+    // 3. Read Results
+    err = clEnqueueReadBuffer(queue, d_hist, blocking, 0, 
+                              (size_t)cellsX * cellsY * BIN_COUNT * sizeof(float), 
+                              hostHist, 0, NULL, readDone);
+    CHECK_CL(err, "Read Results");
+}
+
+void HogOpenCL::launchKernel(cl_command_queue target, cl_kernel kernel, const OpenCLLaunchConfig& config, int cols, int rows, int step, cl_event* done) {
+    int cellsX = cols / CELL_WIDTH;
+    int cellsY = rows / CELL_HEIGHT;
     float binScale = (float)BIN_COUNT / 180.0f;
 
-    clSetKernelArg(kernelHog, 0, sizeof(cl_mem), &d_input);
-    clSetKernelArg(kernelHog, 1, sizeof(cl_mem), &d_hist);
-    clSetKernelArg(kernelHog, 2, sizeof(int), &rows);
-    clSetKernelArg(kernelHog, 3, sizeof(int), &cols);
-    clSetKernelArg(kernelHog, 4, sizeof(int), &step);
-    clSetKernelArg(kernelHog, 5, sizeof(float), &binScale);
+    clSetKernelArg(kernel, 0, sizeof(cl_mem), &d_input);
+    clSetKernelArg(kernel, 1, sizeof(cl_mem), &d_hist);
+    clSetKernelArg(kernel, 2, sizeof(int), &rows);
+    clSetKernelArg(kernel, 3, sizeof(int), &cols);
+    clSetKernelArg(kernel, 4, sizeof(int), &step);
+    clSetKernelArg(kernel, 5, sizeof(float), &binScale);
+    clSetKernelArg(kernel, 6, sizeof(int), &rowStep);
+    clSetKernelArg(kernel, 7, sizeof(int), &cellsX);
+    clSetKernelArg(kernel, 8, sizeof(int), &cellsY);
+
+    // One work-item per CELLS_PER_ITEM cells of a row; with an explicit work-group shape
+    // the global size is padded up to a multiple of it (OpenCL 1.x requires that).
+    size_t itemsX = ((size_t)cellsX + config.cellsPerItem - 1) / config.cellsPerItem;
+    size_t globalSize[2] = { itemsX, (size_t)cellsY };
+    size_t localSize[2] = { (size_t)config.localX, (size_t)config.localY };
+    bool autoLocal = (config.localX <= 0 || config.localY <= 0);
+    if (!autoLocal) {
+        globalSize[0] = (globalSize[0] + localSize[0] - 1) / localSize[0] * localSize[0];
+        globalSize[1] = (globalSize[1] + localSize[1] - 1) / localSize[1] * localSize[1];
+    }
 
-    // 2. Launch Kernel
-    // Note: Local workgroup size is NULL (auto), which works best for this specific logic
-    err = clEnqueueNDRangeKernel(queue, kernelHog, 2, NULL, globalSize, NULL, 0, NULL, NULL);
+    cl_int err = clEnqueueNDRangeKernel(target, kernel, 2, NULL, globalSize, autoLocal ? NULL : localSize, 0, NULL, done);
     CHECK_CL(err, "Kernel Execution");
+}
 
-    // 3. Read Results
-    err = clEnqueueReadBuffer(queue, d_hist, CL_TRUE, 0, 
-                              cellHistograms.size() * sizeof(float), 
-                              cellHistograms.data(), 0, NULL, NULL);
+struct HogOpenCL::AsyncRequest {
+    HogOpenCL* owner;
+    Mat input;
+    bool visualize;
+    HogCallback onComplete;
+    std::promise<HogResult> promise;
+    HogResult result;
+};
+
+std::future<HogResult> HogOpenCL::computeHOGAsync(const Mat& input, bool visualize, HogCallback onComplete) {
+    AsyncRequest* req = new AsyncRequest();
+    req->owner = this;
+    req->input = input.isContinuous() ? input : input.clone();
+    req->visualize = visualize;
+    req->onComplete = std::move(onComplete);
+    std::future<HogResult> result = req->promise.get_future();
+
+    int cellsX = req->input.cols / CELL_WIDTH;
+    int cellsY = req->input.rows / CELL_HEIGHT;
+    req->result.gridSize = Size(cellsX, cellsY);
+    req->result.cellHistograms.resize((size_t)cellsX * cellsY * BIN_COUNT);
+
+    cl_event readDone = NULL;
+    try {
+        allocateBuffers(req->input.cols, req->input.rows);
+        enqueueFrame(req->input, req->result.cellHistograms.data(), CL_FALSE, &readDone);
+    } catch (...) {
+        // Report through the future once anything already queued for this frame
+        // is done with its host buffers.
+        clFinish(queue);
+        req->promise.set_exception(std::current_exception());
+        delete req;
+        return result;
+    }
 
-    if (visualize) return Mat::zeros(img.size(), CV_8UC3);
-    return Mat();
+    asyncStarted();
+    cl_int err = clSetEventCallback(readDone, CL_COMPLETE, onReadComplete, req);
+    if (err != CL_SUCCESS) {
+        // No callback support: complete the frame here
+        clWaitForEvents(1, &readDone);
+        onReadComplete(readDone, CL_COMPLETE, req);
+        return result;
+    }
+    clFlush(queue);
+    return result;
+}
+
+// Runs on an OpenCL runtime thread: host work only, no blocking CL calls.
+void CL_CALLBACK HogOpenCL::onReadComplete(cl_event event, cl_int status, void* userData) {
+    AsyncRequest* req = static_cast<AsyncRequest*>(userData);
+    HogOpenCL* owner = req->owner;
+
+    if (status < 0) {
+        req->promise.set_exception(std::make_exception_ptr(
+            std::runtime_error("[OpenCL Error] Async frame failed. Code: " + std::to_string(status))));
+    } else {
+        try {
+            if (req->visualize) {
+                HistogramGrid grid = HistogramGrid::cellMajor(req->result.cellHistograms.data(),
+                    req->result.gridSize.width, req->result.gridSize.height, BIN_COUNT);
+                req->result.visual = HogVisualizer::render(grid, req->input, false); // Driver callback thread
+            }
+            if (req->onComplete) req->onComplete(req->result);
+            req->promise.set_value(std::move(req->result));
+        } catch (...) {
+            req->promise.set_exception(std::current_exception());
+        }
+    }
+
+    delete req;
+    clReleaseEvent(event);
+    owner->asyncFinished();
+}
+
+HistogramGrid HogOpenCL::getHistogramGrid() const {
+    return HistogramGrid::cellMajor(cellHistograms.data(), currentWidth / CELL_WIDTH, currentHeight / CELL_HEIGHT, BIN_COUNT);
 }
@@ -0,0 +1,331 @@
+#include "../../include/HogOpenCL.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+namespace fs = std::filesystem;
+
+// ==========================================
+// CONFIGURATION
+// ==========================================
+// Synthetic frame the sweep runs on (Full HD, the usual video input)
+static constexpr int TUNE_WIDTH = 1920;
+static constexpr int TUNE_HEIGHT = 1080;
+
+// Kernel launches per configuration: the first ones warm up caches/clocks and are not timed
+static constexpr int WARMUP_RUNS = 3;
+static constexpr int TIMED_RUNS = 20;
+
+// Candidate work-group shapes (x = work-items along a row, each covering cellsPerItem cells);
+// { 0, 0 } = runtime's choice
+static constexpr int LOCAL_SHAPES[][2] = {
+    { 0, 0 }, { 8, 8 }, { 16, 4 }, { 16, 8 }, { 16, 16 }, { 32, 2 }, { 32, 4 },
+    { 32, 8 }, { 64, 1 }, { 64, 2 }, { 64, 4 }, { 128, 1 }, { 256, 1 }
+};
+static constexpr int CELLS_PER_ITEM[] = { 1, 2, 4 };
+static constexpr int VECTOR_WIDTHS[] = { 1, 2, 4, 8 };
+
+// A configuration is only eligible if every bin matches the default launch within this
+// share of the frame's largest bin (vector atan2 may round differently).
+static constexpr float MATCH_TOLERANCE = 1e-3f;
+
+static const char* TUNING_DIR = "../results/opencl_tuning/";
+// ==========================================
+
+#define CHECK_CL(err, msg) \
+    if (err != CL_SUCCESS) { \
+        throw std::runtime_error(std::string("[OpenCL Error] ") + msg + " Code: " + std::to_string(err)); \
+    }
+
+namespace {
+    struct TuneResult {
+        OpenCLLaunchConfig config;
+        double medianMs = 0.0;
+        double minMs = 0.0;
+        string status; // ok, build_failed, unsupported, launch_failed, mismatch
+    };
+
+    string deviceString(cl_device_id device, cl_device_info param) {
+        size_t size = 0;
+        clGetDeviceInfo(device, param, 0, NULL, &size);
+        string value(size, '\0');
+        if (size) clGetDeviceInfo(device, param, size, &value[0], NULL);
+        while (!value.empty() && (value.back() == '\0' || value.back() == ' ')) value.pop_back();
+        return value;
+    }
+
+    // Keeps the file name portable: "NVIDIA GeForce RTX 3060" -> "NVIDIA_GeForce_RTX_3060"
+    string sanitize(const string& text) {
+        string out;
+        for (char c : text) {
+            bool keep = isalnum((unsigned char)c) || c == '.' || c == '-';
+            out += keep ? c : '_';
+        }
+        return out.empty() ? "unknown" : out;
+    }
+
+    // Deterministic, textured frame: every run (and every device) tunes on the same pixels
+    Mat syntheticFrame() {
+        Mat frame(TUNE_HEIGHT, TUNE_WIDTH, CV_8UC3);
+        RNG rng(0x484F47);
+        rng.fill(frame, RNG::UNIFORM, 0, 256);
+        GaussianBlur(frame, frame, Size(5, 5), 1.5);
+        return frame;
+    }
+
+    // The tuning queue is private to autotune() and released on every exit path
+    struct QueueGuard {
+        cl_command_queue queue = NULL;
+        ~QueueGuard() { if (queue) clReleaseCommandQueue(queue); }
+    };
+}
+
+string OpenCLLaunchConfig::describe() const {
+    string local = (localX > 0 && localY > 0) ? to_string(localX) + "x" + to_string(localY) : "auto";
+    return "local " + local + ", " + to_string(cellsPerItem) + " cell(s)/item, vec " + to_string(vectorWidth);
+}
+
+string HogOpenCL::tuningFile() const {
+    return string(TUNING_DIR) + sanitize(deviceString(device, CL_DEVICE_NAME)) + "__" +
+           sanitize(deviceString(device, CL_DRIVER_VERSION)) + ".cfg";
+}
+
+bool HogOpenCL::loadTuning(OpenCLLaunchConfig& config) const {
+    string path = tuningFile();
+    ifstream file(path);
+    if (!file.is_open()) return false;
+
+    OpenCLLaunchConfig loaded;
+    string line;
+    while (getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t eq = line.find('=');
+        if (eq == string::npos) continue;
+        string key = line.substr(0, eq);
+        int value = atoi(line.c_str() + eq + 1);
+        if (key == "localX") loaded.localX = value;
+        else if (key == "localY") loaded.localY = value;
+        else if (key == "cellsPerItem") loaded.cellsPerItem = value;
+        else if (key == "vectorWidth") loaded.vectorWidth = value;
+    }
+
+    bool vectorOk = loaded.vectorWidth == 1 || loaded.vectorWidth == 2 || loaded.vectorWidth == 4 || loaded.vectorWidth == 8;
+    bool localOk = (loaded.localX == 0 && loaded.localY == 0) || (loaded.localX > 0 && loaded.localY > 0);
+    if (!vectorOk || !localOk || loaded.cellsPerItem < 1) {
+        cerr << "[Warning] Ignoring malformed tuning file: " << path << endl;
+        return false;
+    }
+    config = loaded;
+    return true;
+}
+
+void HogOpenCL::saveTuning(const OpenCLLaunchConfig& config, double medianMs) const {
+    if (!fs::exists(TUNING_DIR)) fs::create_directories(TUNING_DIR);
+
+    string path = tuningFile();
+    ofstream file(path);
+    if (!file.is_open()) {
+        cerr << "[Error] Cannot write tuning file: " << path << endl;
+        return;
+    }
+    file << "# HOG OpenCL launch configuration, written by --autotune. Delete to re-tune.\n";
+    file << "# device: " << deviceString(device, CL_DEVICE_NAME) << "\n";
+    file << "# driver: " << deviceString(device, CL_DRIVER_VERSION) << "\n";
+    file << "# kernel: " << medianMs << " ms on " << TUNE_WIDTH << "x" << TUNE_HEIGHT << "\n";
+    file << "localX=" << config.localX << "\n";
+    file << "localY=" << config.localY << "\n";
+    file << "cellsPerItem=" << config.cellsPerItem << "\n";
+    file << "vectorWidth=" << config.vectorWidth << "\n";
+    cout << "[Saved] Tuning to " << path << endl;
+}
+
+void HogOpenCL::autotune(const string& csvName) {
+    waitForPending();
+
+    cout << "\n=== OpenCL Autotune ===" << endl;
+    cout << "[Info] " << deviceString(device, CL_DEVICE_NAME) << ", synthetic " << TUNE_WIDTH << "x" << TUNE_HEIGHT
+         << " frame, median kernel time of " << TIMED_RUNS << " runs per configuration" << endl;
+
+    // Device limits for the work-group shape
+    size_t maxGroup = 0;
+    cl_uint dims = 0;
+    clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(maxGroup), &maxGroup, NULL);
+    clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS, sizeof(dims), &dims, NULL);
+    vector<size_t> maxItems(std::max<cl_uint>(dims, 2), 0);
+    clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_ITEM_SIZES, sizeof(size_t) * dims, maxItems.data(), NULL);
+
+    // Kernel time comes from event profiling, so host launch overhead does not skew the ranking
+    cl_int err;
+    QueueGuard tuning;
+    tuning.queue = clCreateCommandQueue(context, device, CL_QUEUE_PROFILING_ENABLE, &err);
+    CHECK_CL(err, "Create Profiling Queue");
+
+    Mat frame = syntheticFrame();
+    allocateBuffers(frame.cols, frame.rows);
+    err = clEnqueueWriteBuffer(tuning.queue, d_input, CL_TRUE, 0, frame.total() * frame.elemSize(), frame.data, 0, NULL, NULL);
+    CHECK_CL(err, "Upload");
+
+    // Full quality while tuning; the adaptive controller may have lowered it
+    int savedRowStep = rowStep;
+    rowStep = 1;
+
+    size_t histFloats = (size_t)(frame.cols / CELL_WIDTH) * (frame.rows / CELL_HEIGHT) * BIN_COUNT;
+    vector<float> reference, output(histFloats);
+    float referenceMax = 1.0f;
+
+    // Times one configuration and checks its histograms against the default launch
+    const float sentinel = std::numeric_limits<float>::quiet_NaN();
+    auto measure = [&](cl_kernel kernel, TuneResult& r) {
+        // Cells a configuration fails to write keep the NaN instead of the previous
+        // configuration's (correct) histograms, and so fail validation
+        cl_int fillErr = clEnqueueFillBuffer(tuning.queue, d_hist, &sentinel, sizeof(sentinel), 0,
+                                             histFloats * sizeof(float), 0, NULL, NULL);
+        CHECK_CL(fillErr, "Fill Sentinel");
+
+        vector<double> times;
+        for (int run = 0; run < WARMUP_RUNS + TIMED_RUNS; run++) {
+            cl_event done = NULL;
+            launchKernel(tuning.queue, kernel, r.config, frame.cols, frame.rows, (int)frame.step, &done);
+            clWaitForEvents(1, &done);
+
+            cl_ulong t0 = 0, t1 = 0;
+            clGetEventProfilingInfo(done, CL_PROFILING_COMMAND_START, sizeof(t0), &t0, NULL);
+            clGetEventProfilingInfo(done, CL_PROFILING_COMMAND_END, sizeof(t1), &t1, NULL);
+            clReleaseEvent(done);
+            if (run >= WARMUP_RUNS) times.push_back((t1 - t0) * 1e-6);
+        }
+        std::sort(times.begin(), times.end());
+        r.medianMs = times[times.size() / 2];
+        r.minMs = times.front();
+
+        cl_int readErr = clEnqueueReadBuffer(tuning.queue, d_hist, CL_TRUE, 0, histFloats * sizeof(float), output.data(), 0, NULL, NULL);
+        CHECK_CL(readErr, "Read Results");
+
+        if (reference.empty()) {
+            // The first configuration is the default launch; it must cover every cell
+            if (!std::all_of(output.begin(), output.end(), [](float v) { return std::isfinite(v); })) {
+                r.status = "mismatch";
+                return;
+            }
+            reference = output;
+            referenceMax = std::max(1.0f, *std::max_element(reference.begin(), reference.end()));
+            r.status = "ok";
+            return;
+        }
+        // A NaN (unwritten cell) compares false, so it counts as a mismatch
+        float tolerance = MATCH_TOLERANCE * referenceMax;
+        bool match = true;
+        for (size_t i = 0; i < histFloats && match; i++) match = (std::abs(output[i] - reference[i]) <= tolerance);
+        r.status = match ? "ok" : "mismatch";
+    };
+
+    // --- Sweep: one program per (vector width, cells per item), every shape on it ---
+    vector<TuneResult> results;
+    for (int vec : VECTOR_WIDTHS) {
+        for (int cells : CELLS_PER_ITEM) {
+            OpenCLLaunchConfig base;
+            base.vectorWidth = vec;
+            base.cellsPerItem = cells;
+
+            cl_program prog = NULL;
+            cl_kernel kernel = NULL;
+            bool built = buildKernel(base, prog, kernel, false);
+            size_t kernelMaxGroup = 0;
+            if (built) clGetKernelWorkGroupInfo(kernel, device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelMaxGroup), &kernelMaxGroup, NULL);
+
+            for (const auto& shape : LOCAL_SHAPES) {
+                TuneResult r;
+                r.config = base;
+                r.config.localX = shape[0];
+                r.config.localY = shape[1];
+
+                size_t group = (size_t)shape[0] * shape[1];
+                if (!built) {
+                    r.status = "build_failed";
+                } else if (group > kernelMaxGroup || group > maxGroup ||
+                           (size_t)shape[0] > maxItems[0] || (size_t)shape[1] > maxItems[1]) {
+                    r.status = "unsupported";
+                } else {
+                    try {
+                        measure(kernel, r);
+                    } catch (const std::exception&) {
+                        clFinish(tuning.queue);
+                        r.status = "launch_failed";
+                    }
+                }
+                results.push_back(r);
+
+                if (reference.empty()) {
+                    // Without the default launch there is nothing to validate against
+                    if (built) { clReleaseKernel(kernel); clReleaseProgram(prog); }
+                    rowStep = savedRowStep;
+                    throw std::runtime_error("[OpenCL Error] Default launch failed during autotune");
+                }
+            }
+            if (built) {
+                clReleaseKernel(kernel);
+                clReleaseProgram(prog);
+            }
+        }
+    }
+    rowStep = savedRowStep;
+
+    // --- Sweep CSV, next to the benchmark CSVs ---
+    string outputDir = "../results/";
+    if (!fs::exists(outputDir)) fs::create_directories(outputDir);
+    ofstream csv(outputDir + csvName);
+    if (csv.is_open()) {
+        csv << "LocalX,LocalY,CellsPerItem,VectorWidth,MedianMs,MinMs,Status\n";
+        for (const auto& r : results) {
+            csv << r.config.localX << "," << r.config.localY << "," << r.config.cellsPerItem << "," << r.config.vectorWidth
+                << "," << r.medianMs << "," << r.minMs << "," << r.status << "\n";
+        }
+        cout << "[Saved] Sweep to " << outputDir << csvName << endl;
+    }
+
+    // --- Ranking ---
+    vector<const TuneResult*> ranked;
+    for (const auto& r : results) if (r.status == "ok") ranked.push_back(&r);
+    std::sort(ranked.begin(), ranked.end(), [](const TuneResult* a, const TuneResult* b) { return a->medianMs < b->medianMs; });
+
+    const TuneResult& defaults = results.front();
+    const TuneResult& best = *ranked.front();
+    size_t rejected = results.size() - ranked.size();
+
+    cout << "[Autotune] " << ranked.size() << " valid configurations";
+    if (rejected) cout << " (" << rejected << " rejected: see Status column)";
+    cout << ". Fastest:" << endl;
+    for (size_t i = 0; i < std::min<size_t>(5, ranked.size()); i++) {
+        cout << "  " << (i + 1) << ". " << std::left << std::setw(42) << ranked[i]->config.describe() << std::right
+             << std::fixed << std::setprecision(3) << ranked[i]->medianMs << " ms" << endl;
+    }
+    cout << "[Autotune] Default (" << defaults.config.describe() << "): " << defaults.medianMs << " ms -> "
+         << best.medianMs << " ms (" << std::setprecision(2) << defaults.medianMs / std::max(best.medianMs, 1e-9) << "x)" << endl;
+    cout.unsetf(std::ios::floatfield);
+    cout << std::setprecision(6);
+
+    // --- Switch to the winner and remember it for later runs ---
+    cl_program bestProgram = NULL;
+    cl_kernel bestKernel = NULL;
+    if (!buildKernel(best.config, bestProgram, bestKernel, true)) {
+        throw std::runtime_error("[OpenCL Error] Rebuilding the tuned kernel failed");
+    }
+    if (kernelHog) clReleaseKernel(kernelHog);
+    if (program) clReleaseProgram(program);
+    program = bestProgram;
+    kernelHog = bestKernel;
+    launch = best.config;
+
+    saveTuning(best.config, best.medianMs);
+}
@@ -0,0 +1,52 @@
+#include "../../include/HogOpenCVRef.h"
+#include "../../include/HogVisualizer.h"
+#include <algorithm>
+#include <iostream>
+
+using namespace cv;
+using namespace std;
+
+Mat HogOpenCVRef::computeHOG(const Mat& input, bool visualize) {
+    int cellsX = input.cols / CELL_WIDTH;
+    int cellsY = input.rows / CELL_HEIGHT;
+    gridSize = Size(cellsX, cellsY);
+    if (cellsX == 0 || cellsY == 0) {
+        cellHistograms.clear();
+        return Mat();
+    }
+
+    // Rebuild only when the frame geometry changes
+    Size winSize(cellsX * CELL_WIDTH, cellsY * CELL_HEIGHT);
+    if (configured != winSize) {
+        Size cell(CELL_WIDTH, CELL_HEIGHT);
+        hog = HOGDescriptor(winSize, cell, cell, cell, BIN_COUNT);
+        configured = winSize;
+    }
+
+    // One window covering the whole cell-aligned frame
+    Mat roi = input(Rect(0, 0, winSize.width, winSize.height));
+    hog.compute(roi, descriptor, winSize, Size(0, 0));
+    if (descriptor.size() != (size_t)cellsX * cellsY * BIN_COUNT) {
+        cerr << "[Error] Unexpected OpenCV descriptor size: " << descriptor.size() << endl;
+        gridSize = Size();
+        cellHistograms.clear();
+        return Mat();
+    }
+
+    // OpenCV walks blocks column by column; transpose into our row-major grid
+    cellHistograms.resize((size_t)cellsX * cellsY * BIN_COUNT);
+    for (int cx = 0; cx < cellsX; cx++) {
+        for (int cy = 0; cy < cellsY; cy++) {
+            const float* src = &descriptor[((size_t)cx * cellsY + cy) * BIN_COUNT];
+            float* dst = &cellHistograms[((size_t)cy * cellsX + cx) * BIN_COUNT];
+            std::copy(src, src + BIN_COUNT, dst);
+        }
+    }
+
+    if (visualize) return HogVisualizer::render(getHistogramGrid(), input);
+    return Mat();
+}
+
+HistogramGrid HogOpenCVRef::getHistogramGrid() const {
+    return HistogramGrid::cellMajor(cellHistograms.data(), gridSize.width, gridSize.height, BIN_COUNT);
+}
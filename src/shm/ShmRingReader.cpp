@@ -0,0 +1,109 @@
+#include "../../include/ShmRingReader.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace hogshm;
+
+ShmRingReader::ShmRingReader(const string& ringName) {
+    string name = (!ringName.empty() && ringName[0] == '/') ? ringName : "/" + ringName;
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) throw runtime_error("[SHM] shm_open " + name + ": " + strerror(errno));
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < alignUp(sizeof(RingHeader))) {
+        close(fd);
+        throw runtime_error("[SHM] " + name + " is not a descriptor ring");
+    }
+    bytes = (size_t)st.st_size;
+    base = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        base = nullptr;
+        throw runtime_error("[SHM] mmap " + name + ": " + strerror(errno));
+    }
+
+    header = static_cast<const RingHeader*>(base);
+    if (header->magic.load(memory_order_acquire) != MAGIC || header->version != VERSION ||
+        header->slotCount == 0 || bytes < mappingBytes(header->slotCount, header->slotBytes)) {
+        munmap(base, bytes);
+        base = nullptr;
+        throw runtime_error("[SHM] " + name + " is not an initialized version " + to_string(VERSION) + " ring");
+    }
+
+    // Start at the newest frame rather than replaying the ring
+    uint64_t last = header->lastSeq.load(memory_order_acquire);
+    nextSeq = last ? last : 1;
+}
+
+ShmRingReader::~ShmRingReader() {
+    if (base) munmap(base, bytes);
+}
+
+const SlotHeader* ShmRingReader::slot(uint64_t seq) const {
+    const char* slots = static_cast<const char*>(base) + alignUp(sizeof(RingHeader));
+    return reinterpret_cast<const SlotHeader*>(slots + ((seq - 1) % header->slotCount) * header->slotBytes);
+}
+
+bool ShmRingReader::acquire(FrameView& view) {
+    while (true) {
+        uint64_t last = header->lastSeq.load(memory_order_acquire);
+        if (nextSeq > last) return false;
+
+        // Fell more than a full ring behind: everything older than the ring is gone
+        if (last - nextSeq >= header->slotCount) {
+            uint64_t oldest = last - header->slotCount + 1;
+            dropped += oldest - nextSeq;
+            nextSeq = oldest;
+        }
+
+        const SlotHeader* s = slot(nextSeq);
+        uint64_t v = s->seq.load(memory_order_acquire);
+        if ((v >> 1) > nextSeq) {
+            // Overwritten by a newer frame before we got to it
+            dropped++;
+            nextSeq++;
+            continue;
+        }
+        if (v != (nextSeq << 1)) return false; // Not published yet
+
+        view.seq = nextSeq;
+        view.frameId = s->frameId;
+        view.timestampNs = s->timestampNs;
+        view.cellsX = s->cellsX;
+        view.cellsY = s->cellsY;
+        view.bins = s->bins;
+        view.cellStride = s->cellStride;
+        view.data = reinterpret_cast<const float*>(s + 1);
+        nextSeq++;
+
+        // Metadata must be consistent before handing out the view
+        if (!validate(view) ||
+            (uint64_t)view.cellsX * view.cellsY * view.cellStride > header->payloadCapacity) {
+            dropped++;
+            continue;
+        }
+        return true;
+    }
+}
+
+bool ShmRingReader::validate(const FrameView& view) const {
+    atomic_thread_fence(memory_order_acquire);
+    return slot(view.seq)->seq.load(memory_order_relaxed) == (view.seq << 1);
+}
+
+bool ShmRingReader::readCopy(FrameView& meta, vector<float>& out) {
+    if (!acquire(meta)) return false;
+    size_t n = (size_t)meta.cellsX * meta.cellsY * meta.cellStride;
+    out.assign(meta.data, meta.data + n);
+    if (!validate(meta)) {
+        dropped++;
+        return false;
+    }
+    return true;
+}
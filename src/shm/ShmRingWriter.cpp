@@ -0,0 +1,106 @@
+#include "../../include/ShmRingWriter.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace hogshm;
+
+static string shmPath(const string& name) {
+    return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+ShmRingWriter::ShmRingWriter(const string& ringName, uint32_t slotCount, uint32_t payloadCapacityFloats,
+                             bool replaceExisting)
+    : name(shmPath(ringName)) {
+    if (slotCount == 0) throw runtime_error("[SHM] Ring needs at least one slot");
+
+    // Never take over a name silently: it may belong to a producer that is still running
+    if (replaceExisting) shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        int e = errno;
+        if (e == EEXIST) {
+            throw runtime_error("[SHM] " + name + " already exists (another producer, or a ring left by a "
+                                "crashed run); use another name or --shm-replace to take it over");
+        }
+        throw runtime_error("[SHM] shm_open " + name + ": " + strerror(e));
+    }
+
+    size_t slotBytes = slotBytesFor(payloadCapacityFloats);
+    bytes = mappingBytes(slotCount, slotBytes);
+    if (ftruncate(fd, (off_t)bytes) != 0) {
+        int e = errno;
+        close(fd);
+        shm_unlink(name.c_str());
+        throw runtime_error("[SHM] ftruncate " + name + ": " + strerror(e));
+    }
+
+    base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        base = nullptr;
+        shm_unlink(name.c_str());
+        throw runtime_error("[SHM] mmap " + name + ": " + strerror(errno));
+    }
+
+    // ftruncate zero-fills the object, so every slot starts as "never written" (seq 0)
+    header = new (base) RingHeader;
+    header->version = VERSION;
+    header->slotCount = slotCount;
+    header->payloadCapacity = payloadCapacityFloats;
+    header->slotBytes = slotBytes;
+    header->lastSeq.store(0, memory_order_relaxed);
+
+    char* slots = static_cast<char*>(base) + alignUp(sizeof(RingHeader));
+    for (uint32_t i = 0; i < slotCount; i++) {
+        SlotHeader* s = new (slots + i * slotBytes) SlotHeader;
+        s->seq.store(0, memory_order_relaxed);
+    }
+
+    // Consumers refuse to attach until the magic is visible
+    header->magic.store(MAGIC, memory_order_release);
+}
+
+ShmRingWriter::~ShmRingWriter() {
+    if (base) munmap(base, bytes);
+    shm_unlink(name.c_str());
+}
+
+bool ShmRingWriter::publish(uint64_t frameId, const HistogramGrid& grid, uint32_t bins) {
+    size_t rowFloats = (size_t)grid.cellsX * grid.cellStride;
+    size_t totalFloats = rowFloats * grid.cellsY;
+    if (grid.empty() || totalFloats > header->payloadCapacity) return false;
+
+    uint64_t seq = nextSeq++;
+    char* slots = static_cast<char*>(base) + alignUp(sizeof(RingHeader));
+    SlotHeader* s = reinterpret_cast<SlotHeader*>(slots + ((seq - 1) % header->slotCount) * header->slotBytes);
+    float* payload = reinterpret_cast<float*>(s + 1);
+
+    // 1. Mark the slot as being written (odd), ordered before any payload store
+    s->seq.store((seq << 1) | 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    // 2. Metadata + payload, dense rows
+    s->frameId = frameId;
+    s->timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    s->cellsX = grid.cellsX;
+    s->cellsY = grid.cellsY;
+    s->bins = bins;
+    s->cellStride = grid.cellStride;
+    s->payloadFloats = (uint32_t)totalFloats;
+    for (int cy = 0; cy < grid.cellsY; cy++) {
+        memcpy(payload + cy * rowFloats, grid.cell(0, cy), rowFloats * sizeof(float));
+    }
+
+    // 3. Publish (even), then advertise it as the newest frame
+    s->seq.store(seq << 1, memory_order_release);
+    header->lastSeq.store(seq, memory_order_release);
+    return true;
+}
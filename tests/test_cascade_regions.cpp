@@ -0,0 +1,73 @@
+// Cascade fine pass over two L-shaped regions whose bounding boxes overlap:
+// every kept cell must match a full-resolution pass over the whole frame exactly.
+#include "../include/HogCascade.h"
+#include "../include/HogCPU.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace cv;
+
+// Grid of the test frame, in cells
+static constexpr int GRID_CELLS = 40;
+
+static void markL(Mat& mask, int x, int y, int down, int right) {
+    for (int dy = 0; dy <= down; dy++) mask.at<uchar>(y + dy, x) = 1;
+    for (int dx = 0; dx <= right; dx++) mask.at<uchar>(y + down, x + dx) = 1;
+}
+
+int main() {
+    constexpr int CW = HogDetector::CELL_WIDTH;
+    constexpr int CH = HogDetector::CELL_HEIGHT;
+    constexpr int BINS = HogDetector::BIN_COUNT;
+
+    Mat frame(GRID_CELLS * CH, GRID_CELLS * CW, CV_8UC3);
+    RNG(1234).fill(frame, RNG::UNIFORM, 0, 256);
+
+    // A: column 5 (rows 5-25) + row 25 (columns 5-20); labelled, hence computed, first.
+    // B: row 10 (columns 10-30) + column 30 (rows 10-35). With its margin, B's box starts
+    //    at column 9, so A's cell (9, 25) sits on the left edge of B's ROI, where B has no
+    //    pixels to its left. Before the fix B overwrote that cell.
+    Mat mask = Mat::zeros(GRID_CELLS, GRID_CELLS, CV_8U);
+    markL(mask, 5, 5, 20, 15);
+    for (int x = 10; x <= 30; x++) mask.at<uchar>(10, x) = 1;
+    for (int y = 10; y <= 35; y++) mask.at<uchar>(y, 30) = 1;
+
+    HogSequential full;
+    full.computeHOG(frame, false);
+    HistogramGrid expected = full.getHistogramGrid();
+
+    HogSequential backend;
+    HogCascade cascade(&backend, 1.0);
+    cascade.computeMasked(frame, mask);
+    HistogramGrid actual = cascade.getHistogramGrid();
+
+    if (actual.cellsX != expected.cellsX || actual.cellsY != expected.cellsY) {
+        printf("FAIL: grid %dx%d, expected %dx%d\n", actual.cellsX, actual.cellsY, expected.cellsX, expected.cellsY);
+        return 1;
+    }
+    if (cascade.lastStats().regions != 2) {
+        printf("FAIL: %d regions, expected 2\n", cascade.lastStats().regions);
+        return 1;
+    }
+
+    int wrong = 0;
+    for (int cy = 0; cy < GRID_CELLS; cy++) {
+        for (int cx = 0; cx < GRID_CELLS; cx++) {
+            const float* a = actual.cell(cx, cy);
+            if (!mask.at<uchar>(cy, cx)) {
+                for (int b = 0; b < BINS; b++) if (a[b] != 0.0f) { wrong++; break; }
+                continue;
+            }
+            if (memcmp(a, expected.cell(cx, cy), BINS * sizeof(float)) != 0) {
+                if (wrong < 10) printf("Cell (%d, %d) differs from the full pass\n", cx, cy);
+                wrong++;
+            }
+        }
+    }
+    if (wrong) {
+        printf("FAIL: %d cells differ\n", wrong);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}